@@ -882,6 +882,8 @@ excel_shared_formula_free (XLSharedFormula *sf)
 {
 	if (sf != NULL) {
 		g_free (sf->data);
+		if (sf->texpr)
+			gnm_expr_top_unref (sf->texpr);
 		g_free (sf);
 	}
 }
@@ -2906,6 +2908,8 @@ excel_formula_shared (BiffQuery *q, ExcelReadSheet *esheet, GnmCell *cell)
 		sf->data_len = data_len;
 		sf->array_data_len = array_data_len;
 		sf->being_parsed = FALSE;
+		/* Set by excel_parse_formula if the parse is the same for all.  */
+		sf->texpr = NULL;
 
 		d (1, g_printerr ("Shared formula, extent %s\n", range_as_string (&r)););
 
@@ -57,6 +57,7 @@ typedef struct {
 	guint32 data_len, array_data_len;
 	gboolean is_array;
 	gboolean being_parsed;
+	GnmExprTop const *texpr;	/* Once parsed, if not position dependent */
 } XLSharedFormula;
 
 typedef struct {
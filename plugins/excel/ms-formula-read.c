@@ -542,8 +542,10 @@ xl_expr_err (ExcelReadSheet const *esheet, int col, int row,
 /**
  *  A useful routine for extracting data from a common
  * storage structure.
+ *
+ * Returns: %TRUE if the reference depends on @curcol and @currow.
  **/
-static void
+static gboolean
 getRefV7 (GnmCellRef *cr,
 	  guint8 col, guint16 gbitrw, int curcol, int currow,
 	  gboolean const shared)
@@ -585,12 +587,16 @@ getRefV7 (GnmCellRef *cr,
 		/* By construction this cannot exceed 0xff. */
 		cr->col = col;
 	}
+
+	return !shared && (cr->row_relative || cr->col_relative);
 }
 
 /**
  * A useful routine for extracting data from a common storage structure.
+ *
+ * Returns: %TRUE if the reference depends on @curcol and @currow.
  **/
-static void
+static gboolean
 getRefV8 (GnmCellRef *cr,
 	  guint16 row, guint16 gbitcl, int curcol, int currow,
 	  gboolean const shared, GnmSheetSize const *ss)
@@ -626,6 +632,19 @@ getRefV8 (GnmCellRef *cr,
 		/* By construction this cannot exceed 0xff. */
 		cr->col = col;
 	}
+
+	return !shared && (cr->row_relative || cr->col_relative);
+}
+
+/*
+ * value_new_cellrange uses the position to order the corners of a range
+ * when they differ in relativity.
+ */
+static gboolean
+cellrange_uses_pos (GnmCellRef const *a, GnmCellRef const *b)
+{
+	return (a->col_relative != b->col_relative ||
+		a->row_relative != b->row_relative);
 }
 
 static void
@@ -1002,6 +1021,8 @@ do {								\
 /**
  * Parse that RP Excel formula, see S59E2B.HTM
  * Return a dynamicly allocated GnmExpr containing the formula, or NULL
+ * @uses_pos is set to whether the result depends on @fn_col and @fn_row
+ * beyond what relative references express.
  **/
 static GnmExpr const *
 excel_parse_formula1 (MSContainer const *container,
@@ -1009,7 +1030,8 @@ excel_parse_formula1 (MSContainer const *container,
 		      int fn_col, int fn_row,
 		      guint8 const *mem, guint16 length, guint16 array_length,
 		      gboolean shared,
-		      gboolean *array_element)
+		      gboolean *array_element,
+		      gboolean *uses_pos)
 {
 	MsBiffVersion const ver = container->importer->ver;
 	GnmSheetSize const *ss = esheet
@@ -1031,6 +1053,7 @@ excel_parse_formula1 (MSContainer const *container,
 
 	if (array_element != NULL)
 		*array_element = FALSE;
+	*uses_pos = FALSE;
 
 #ifndef NO_DEBUG_EXCEL
 	if (ms_excel_formula_debug > 1) {
@@ -1101,7 +1124,7 @@ excel_parse_formula1 (MSContainer const *container,
 			sf->being_parsed = TRUE;
 			expr = excel_parse_formula1 (container, esheet, fn_col, fn_row,
 						     sf->data, sf->data_len, sf->array_data_len,
-						     TRUE, array_element);
+						     TRUE, array_element, uses_pos);
 			sf->being_parsed = FALSE;
 			parse_list_push (&stack, expr);
 			ptg_length = length; /* Force it to be the only token */
@@ -1384,14 +1407,19 @@ excel_parse_formula1 (MSContainer const *container,
 				 */
 				GnmCellRef ref;
 				CHECK_FORMULA_LEN(5);
-				getRefV8 (&ref,
-					  GSF_LE_GET_GUINT16 (cur + 1),
-					  GSF_LE_GET_GUINT16 (cur + 3),
-					  fn_col, fn_row, shared, ss);
-				if ((eptg % 2))	/* Column are odd */
+				*uses_pos |= getRefV8 (&ref,
+						       GSF_LE_GET_GUINT16 (cur + 1),
+						       GSF_LE_GET_GUINT16 (cur + 3),
+						       fn_col, fn_row, shared, ss);
+				if ((eptg % 2)) { /* Column are odd */
+					if (!ref.row_relative)
+						*uses_pos = TRUE;
 					ref.row = ref.row_relative ? 0 : fn_row;
-				else		/* Row */
+				} else {	/* Row */
+					if (!ref.col_relative)
+						*uses_pos = TRUE;
 					ref.col = ref.col_relative ? 0 : fn_col;
+				}
 
 				parse_list_push (&stack, gnm_expr_new_cellref (&ref));
 				break;
@@ -1650,17 +1678,17 @@ excel_parse_formula1 (MSContainer const *container,
 			GnmCellRef ref;
 			if (ver >= MS_BIFF_V8) {
 				CHECK_FORMULA_LEN(4);
-				getRefV8 (&ref,
-					  GSF_LE_GET_GUINT16 (cur),
-					  GSF_LE_GET_GUINT16 (cur + 2),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_REFN,
-					  ss);
+				*uses_pos |= getRefV8 (&ref,
+						       GSF_LE_GET_GUINT16 (cur),
+						       GSF_LE_GET_GUINT16 (cur + 2),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_REFN,
+						       ss);
 			} else {
 				CHECK_FORMULA_LEN(3);
-				getRefV7 (&ref,
-					  GSF_LE_GET_GUINT8 (cur+2),
-					  GSF_LE_GET_GUINT16 (cur),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_REFN);
+				*uses_pos |= getRefV7 (&ref,
+						       GSF_LE_GET_GUINT8 (cur+2),
+						       GSF_LE_GET_GUINT16 (cur),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_REFN);
 			}
 			parse_list_push (&stack, gnm_expr_new_cellref (&ref));
 			break;
@@ -1670,28 +1698,29 @@ excel_parse_formula1 (MSContainer const *container,
 			GnmCellRef first, last;
 			if (ver >= MS_BIFF_V8) {
 				CHECK_FORMULA_LEN(8);
-				getRefV8 (&first,
-					  GSF_LE_GET_GUINT16 (cur+0),
-					  GSF_LE_GET_GUINT16 (cur+4),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN,
-					  ss);
-				getRefV8 (&last,
-					  GSF_LE_GET_GUINT16 (cur+2),
-					  GSF_LE_GET_GUINT16 (cur+6),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN,
-					  ss);
+				*uses_pos |= getRefV8 (&first,
+						       GSF_LE_GET_GUINT16 (cur+0),
+						       GSF_LE_GET_GUINT16 (cur+4),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN,
+						       ss);
+				*uses_pos |= getRefV8 (&last,
+						       GSF_LE_GET_GUINT16 (cur+2),
+						       GSF_LE_GET_GUINT16 (cur+6),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN,
+						       ss);
 			} else {
 				CHECK_FORMULA_LEN(6);
-				getRefV7 (&first,
-					  GSF_LE_GET_GUINT8 (cur+4),
-					  GSF_LE_GET_GUINT16 (cur+0),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN);
-				getRefV7 (&last,
-					  GSF_LE_GET_GUINT8 (cur+5),
-					  GSF_LE_GET_GUINT16 (cur+2),
-					  fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN);
+				*uses_pos |= getRefV7 (&first,
+						       GSF_LE_GET_GUINT8 (cur+4),
+						       GSF_LE_GET_GUINT16 (cur+0),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN);
+				*uses_pos |= getRefV7 (&last,
+						       GSF_LE_GET_GUINT8 (cur+5),
+						       GSF_LE_GET_GUINT16 (cur+2),
+						       fn_col, fn_row, ptgbase == FORMULA_PTG_AREAN);
 			}
 
+			*uses_pos |= cellrange_uses_pos (&first, &last);
 			parse_list_push_raw (&stack, value_new_cellrange (&first, &last, fn_col, fn_row));
 			break;
 		}
@@ -1786,17 +1815,17 @@ excel_parse_formula1 (MSContainer const *container,
 			GnmCellRef first, last;
 			if (ver >= MS_BIFF_V8) {
 				CHECK_FORMULA_LEN(6);
-				getRefV8 (&first,
-					  GSF_LE_GET_GUINT16 (cur + 2),
-					  GSF_LE_GET_GUINT16 (cur + 4),
-					  fn_col, fn_row, FALSE, ss);
+				*uses_pos |= getRefV8 (&first,
+						       GSF_LE_GET_GUINT16 (cur + 2),
+						       GSF_LE_GET_GUINT16 (cur + 4),
+						       fn_col, fn_row, FALSE, ss);
 				last = first;
 			} else {
 				CHECK_FORMULA_LEN(17);
-				getRefV7 (&first,
-					  GSF_LE_GET_GUINT8  (cur + 16),
-					  GSF_LE_GET_GUINT16 (cur + 14),
-					  fn_col, fn_row, shared);
+				*uses_pos |= getRefV7 (&first,
+						       GSF_LE_GET_GUINT8  (cur + 16),
+						       GSF_LE_GET_GUINT16 (cur + 14),
+						       fn_col, fn_row, shared);
 				last = first;
 			}
 
@@ -1815,25 +1844,26 @@ excel_parse_formula1 (MSContainer const *container,
 
 			if (ver >= MS_BIFF_V8) {
 				CHECK_FORMULA_LEN(10);
-				getRefV8 (&first,
-					  GSF_LE_GET_GUINT16 (cur+2),
-					  GSF_LE_GET_GUINT16 (cur+6),
-					  fn_col, fn_row, FALSE, ss);
-				getRefV8 (&last,
-					  GSF_LE_GET_GUINT16 (cur+4),
-					  GSF_LE_GET_GUINT16 (cur+8),
-					  fn_col, fn_row, FALSE, ss);
+				*uses_pos |= getRefV8 (&first,
+						       GSF_LE_GET_GUINT16 (cur+2),
+						       GSF_LE_GET_GUINT16 (cur+6),
+						       fn_col, fn_row, FALSE, ss);
+				*uses_pos |= getRefV8 (&last,
+						       GSF_LE_GET_GUINT16 (cur+4),
+						       GSF_LE_GET_GUINT16 (cur+8),
+						       fn_col, fn_row, FALSE, ss);
 			} else {
 				CHECK_FORMULA_LEN(20);
-				getRefV7 (&first,
-					  GSF_LE_GET_GUINT8 (cur+18),
-					  GSF_LE_GET_GUINT16 (cur+14),
-					  fn_col, fn_row, shared);
-				getRefV7 (&last,
-					  GSF_LE_GET_GUINT8 (cur+19),
-					  GSF_LE_GET_GUINT16 (cur+16),
-					  fn_col, fn_row, shared);
+				*uses_pos |= getRefV7 (&first,
+						       GSF_LE_GET_GUINT8 (cur+18),
+						       GSF_LE_GET_GUINT16 (cur+14),
+						       fn_col, fn_row, shared);
+				*uses_pos |= getRefV7 (&last,
+						       GSF_LE_GET_GUINT8 (cur+19),
+						       GSF_LE_GET_GUINT16 (cur+16),
+						       fn_col, fn_row, shared);
 			}
+			*uses_pos |= cellrange_uses_pos (&first, &last);
 			if (excel_formula_parses_ref_sheets (container, cur, &first.sheet, &last.sheet))
 				parse_list_push_raw (&stack, value_new_error_REF (NULL));
 			else
@@ -1911,13 +1941,50 @@ excel_parse_formula (MSContainer const *container,
 		     gboolean shared,
 		     gboolean *array_element)
 {
-	GnmExprTop const *texpr =
-		gnm_expr_top_new (excel_parse_formula1 (container, esheet,
+	GnmExprTop const *texpr;
+	XLSharedFormula *sf = NULL;
+	gboolean uses_pos;
+
+	/*
+	 * A formula that only refers to a shared formula comes out the
+	 * same in every cell of the group since the shared formula's
+	 * references are stored relative to the cell.  Parse it once,
+	 * unless the parse turns out to depend on the cell's position.
+	 */
+	if (!shared && esheet != NULL &&
+	    length >= 4 && GSF_LE_GET_GUINT8 (mem) == FORMULA_PTG_EXPR) {
+		GnmCellPos top_left;
+
+		top_left.row = GSF_LE_GET_GUINT16 (mem + 1);
+		if (container->importer->ver >= MS_BIFF_V3) {
+			if (length < 5)
+				goto parse;
+			top_left.col = GSF_LE_GET_GUINT16 (mem + 3);
+		} else
+			top_left.col = GSF_LE_GET_GUINT8 (mem + 3);
+
+		sf = excel_sheet_shared_formula (esheet, &top_left);
+		if (sf && sf->is_array)
+			sf = NULL;
+		if (sf && sf->texpr) {
+			if (array_element != NULL)
+				*array_element = FALSE;
+			return gnm_expr_top_ref (sf->texpr);
+		}
+	}
+
+parse:
+	texpr = gnm_expr_top_new (excel_parse_formula1 (container, esheet,
 							fn_col, fn_row,
 							mem, length, array_length,
 							shared,
-							array_element));
-	return texpr
-		? gnm_expr_sharer_share (container->importer->expr_sharer, texpr)
-		: NULL;
+							array_element,
+							&uses_pos));
+	if (!texpr)
+		return NULL;
+
+	texpr = gnm_expr_sharer_share (container->importer->expr_sharer, texpr);
+	if (sf && !uses_pos)
+		sf->texpr = gnm_expr_top_ref (texpr);
+	return texpr;
 }
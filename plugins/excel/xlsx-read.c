@@ -191,6 +191,8 @@ typedef struct {
 	/* Rows/Cols state */
 	GnmStyle          *pending_rowcol_style;
 	GnmRange           pending_rowcol_range;
+	GnmStyle          *pending_cell_style;
+	GnmRange           pending_cell_range;
 
 	/* Drawing state */
 	SheetObject	   *so;
@@ -1508,6 +1510,19 @@ xlsx_cell_expr_end (GsfXMLIn *xin, G_GNUC_UNUSED GsfXMLBlob *blob)
 	state->shared_id = NULL;
 }
 
+static void
+xlsx_cell_style_flush (XLSXReadState *state)
+{
+	if (!state->pending_cell_style)
+		return;
+
+	sheet_style_apply_range (state->sheet,
+				 &state->pending_cell_range,
+				 state->pending_cell_style);
+
+	state->pending_cell_style = NULL;
+}
+
 static void
 xlsx_cell_begin (GsfXMLIn *xin, xmlChar const **attrs)
 {
@@ -1538,10 +1553,25 @@ xlsx_cell_begin (GsfXMLIn *xin, xmlChar const **attrs)
 			style = xlsx_get_xf (xin, tmp);
 
 	if (NULL != style) {
-		gnm_style_ref (style);
-		/* There may already be a row style set!*/
-		sheet_style_apply_pos (state->sheet,
-			state->pos.col, state->pos.row, style);
+		/*
+		 * Neighbouring cells very often share a style.  Applying
+		 * it a run at a time is much cheaper than cell by cell.
+		 */
+		if (style != state->pending_cell_style ||
+		    state->pending_cell_range.start.row != state->pos.row ||
+		    state->pending_cell_range.end.col + 1 != state->pos.col)
+			xlsx_cell_style_flush (state);
+
+		if (state->pending_cell_style)
+			state->pending_cell_range.end.col = state->pos.col;
+		else {
+			/* There may already be a row style set!*/
+			gnm_style_ref (style);
+			state->pending_cell_style = style;
+			range_init (&state->pending_cell_range,
+				    state->pos.col, state->pos.row,
+				    state->pos.col, state->pos.row);
+		}
 	}
 }
 
@@ -1657,6 +1687,7 @@ static void
 xlsx_CT_Row_end (GsfXMLIn *xin, G_GNUC_UNUSED GsfXMLBlob *blob)
 {
 	XLSXReadState *state = (XLSXReadState *)xin->user_state;
+	xlsx_cell_style_flush (state);
 	// The next implied row is the one below
 	state->pos.row++;
 }
@@ -5403,6 +5434,7 @@ xlsx_file_open (G_GNUC_UNUSED GOFileOpener const *fo, GOIOContext *context,
 	if (state.cur_style) g_object_unref (state.cur_style);
 	if (state.style_accum) gnm_style_unref (state.style_accum);
 	if (state.pending_rowcol_style) gnm_style_unref (state.pending_rowcol_style);
+	if (state.pending_cell_style) gnm_style_unref (state.pending_cell_style);
 	style_color_unref (state.border_color);
 
 	workbook_set_saveinfo (state.wb, GO_FILE_FL_AUTO,
@@ -1573,6 +1573,9 @@ xlsx_write_cells (XLSXWriteState *state, GsfXMLOut *xml,
 	guint cno = 0;
 	int *boring_count;
 	GByteArray *non_defaults_rows = sheet_style_get_nondefault_rows (sheet, col_styles);
+	GString *str = g_string_new (NULL);
+	GnmStyle const *last_style = NULL;
+	gint last_style_id = -1;
 
 	boring_count = g_new0 (int, extent->end.row + 1);
 	r = extent->end.row;
@@ -1660,9 +1663,18 @@ xlsx_write_cells (XLSXWriteState *state, GsfXMLOut *xml,
 				style = style1 = gnm_style_dup (style);
 				gnm_style_set_format (style1, fmt2);
 			}
-			style_id = style && style != g_ptr_array_index (col_styles, c)
-				? xlsx_get_style_id (state, style)
-				: -1;
+			if (!style || style == g_ptr_array_index (col_styles, c))
+				style_id = -1;
+			else if (style1)
+				style_id = xlsx_get_style_id (state, style);
+			else {
+				/* Neighbouring cells mostly share their style.  */
+				if (style != last_style) {
+					last_style = style;
+					last_style_id = xlsx_get_style_id (state, style);
+				}
+				style_id = last_style_id;
+			}
 			if (style1)
 				gnm_style_unref (style1);
 
@@ -1758,10 +1770,13 @@ xlsx_write_cells (XLSXWriteState *state, GsfXMLOut *xml,
 					else if (VALUE_IS_BOOLEAN (val))
 						xlsx_add_bool (xml, NULL, value_get_as_int (val));
 					else {
-						GString *str = g_string_new (NULL);
+						g_string_truncate (str, 0);
 						value_get_as_gstring (cell->value, str, state->convs);
-						gsf_xml_out_add_cstr (xml, NULL, str->str);
-						g_string_free (str, TRUE);
+						/* Numbers never need escaping.  */
+						if (VALUE_IS_FLOAT (val))
+							gsf_xml_out_add_cstr_unchecked (xml, NULL, str->str);
+						else
+							gsf_xml_out_add_cstr (xml, NULL, str->str);
 					}
 					gsf_xml_out_end_element (xml); /* </v> */
 				}
@@ -1784,6 +1799,7 @@ xlsx_write_cells (XLSXWriteState *state, GsfXMLOut *xml,
 	g_free (boring_count);
 	g_ptr_array_free (all_cells, TRUE);
 	g_free (cheesy_span);
+	g_string_free (str, TRUE);
 }
 
 static void
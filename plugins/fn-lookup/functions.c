@@ -113,9 +113,20 @@ static GHashTable *bisection_vlookup_string_cache;
 static GHashTable *bisection_vlookup_float_cache;
 static GHashTable *bisection_vlookup_bool_cache;
 static size_t total_cache_size;
+static size_t dead_cache_size;
 static size_t protect_string_pool;
 static size_t protect_float_pool;
 
+/*
+ * Entries keyed by a cell range survive recalcs until something in the
+ * range changes.  For each such range we hold a range watch; ranges whose
+ * watch has gone stale are dropped from all the caches before the next
+ * lookup.  Entries keyed by an array are keyed by content and never go
+ * stale.
+ */
+static GHashTable *lookup_watchers;
+static unsigned lookup_watch_generation;
+
 static void
 clear_caches (void)
 {
@@ -123,9 +134,17 @@ clear_caches (void)
 		return;
 
 	if (debug_lookup_caches)
-		g_printerr ("Clearing lookup caches [%ld]\n", (long)total_cache_size);
+		g_printerr ("Clearing lookup caches [%ld elements, %d ranges]\n",
+			    (long)total_cache_size,
+			    g_hash_table_size (lookup_watchers));
 
 	total_cache_size = 0;
+	dead_cache_size = 0;
+
+	/* ---------- */
+
+	g_hash_table_destroy (lookup_watchers);
+	lookup_watchers = NULL;
 
 	/* ---------- */
 
@@ -191,6 +210,7 @@ create_caches (void)
 		return;
 
 	total_cache_size = 0;
+	dead_cache_size = 0;
 
 	if (!lookup_string_pool)
 		lookup_string_pool = g_string_chunk_new (100 * 1024);
@@ -201,6 +221,12 @@ create_caches (void)
 					  sizeof (gnm_float),
 					  sizeof (gnm_float) * 1000);
 
+	lookup_watchers = g_hash_table_new_full
+		((GHashFunc)value_hash,
+		 (GEqualFunc)value_equal,
+		 (GDestroyNotify)value_release,
+		 (GDestroyNotify)gnm_range_watch_unref);
+
 	linear_hlookup_string_cache = g_hash_table_new_full
 		((GHashFunc)value_hash,
 		 (GEqualFunc)value_equal,
@@ -266,10 +292,16 @@ create_caches (void)
 		 (GDestroyNotify)lookup_bisection_cache_item_free);
 }
 
+/*
+ * The pools cannot free single strings or floats, so purged entries
+ * leave dead_cache_size elements behind in them.  Those are only
+ * reclaimed by a full clear, which we also do once too much is dead.
+ */
 static void
 prune_caches (void)
 {
-	if (total_cache_size > 10 * GNM_DEFAULT_ROWS) {
+	if (total_cache_size > 10 * GNM_DEFAULT_ROWS ||
+	    dead_cache_size > 10 * GNM_DEFAULT_ROWS) {
 		clear_caches ();
 		create_caches ();
 	}
@@ -277,6 +309,93 @@ prune_caches (void)
 
 /* -------------------------------------------------------------------------- */
 
+static void
+lookup_cache_purge_size (size_t n)
+{
+	n = MIN (n, total_cache_size);
+	total_cache_size -= n;
+	dead_cache_size += n;
+}
+
+static void
+linear_lookup_cache_remove (GHashTable *cache, GnmValue const *key)
+{
+	GHashTable *h = g_hash_table_lookup (cache, key);
+	if (h) {
+		lookup_cache_purge_size (g_hash_table_size (h));
+		g_hash_table_remove (cache, key);
+	}
+}
+
+static void
+bisection_lookup_cache_remove (GHashTable *cache, GnmValue const *key)
+{
+	LookupBisectionCacheItem *item = g_hash_table_lookup (cache, key);
+	if (item) {
+		lookup_cache_purge_size (item->n);
+		g_hash_table_remove (cache, key);
+	}
+}
+
+static void
+lookup_caches_remove_key (GnmValue const *key)
+{
+	linear_lookup_cache_remove (linear_hlookup_string_cache, key);
+	linear_lookup_cache_remove (linear_hlookup_float_cache, key);
+	linear_lookup_cache_remove (linear_hlookup_bool_cache, key);
+	linear_lookup_cache_remove (linear_vlookup_string_cache, key);
+	linear_lookup_cache_remove (linear_vlookup_float_cache, key);
+	linear_lookup_cache_remove (linear_vlookup_bool_cache, key);
+	bisection_lookup_cache_remove (bisection_hlookup_string_cache, key);
+	bisection_lookup_cache_remove (bisection_hlookup_float_cache, key);
+	bisection_lookup_cache_remove (bisection_hlookup_bool_cache, key);
+	bisection_lookup_cache_remove (bisection_vlookup_string_cache, key);
+	bisection_lookup_cache_remove (bisection_vlookup_float_cache, key);
+	bisection_lookup_cache_remove (bisection_vlookup_bool_cache, key);
+}
+
+static void
+lookup_cache_watch (GnmValue const *key)
+{
+	if (!VALUE_IS_CELLRANGE (key) ||
+	    g_hash_table_lookup (lookup_watchers, key))
+		return;
+
+	g_hash_table_insert (lookup_watchers, value_dup (key),
+			     gnm_range_watch_new (key));
+}
+
+static gboolean
+cb_purge_stale (GnmValue const *key, GnmRangeWatch *w,
+		G_GNUC_UNUSED gpointer user)
+{
+	gboolean stale = gnm_range_watch_is_stale (w);
+	if (stale)
+		lookup_caches_remove_key (key);
+	return stale;
+}
+
+static void
+purge_stale_caches (void)
+{
+	unsigned generation = gnm_range_watch_generation ();
+
+	if (generation == lookup_watch_generation || !lookup_watchers)
+		return;
+
+	lookup_watch_generation = generation;
+	g_hash_table_foreach_remove (lookup_watchers,
+				     (GHRFunc)cb_purge_stale, NULL);
+
+	if (debug_lookup_caches)
+		g_printerr ("Purged stale lookup caches [%ld elements, %ld dead, %d ranges]\n",
+			    (long)total_cache_size,
+			    (long)dead_cache_size,
+			    g_hash_table_size (lookup_watchers));
+}
+
+/* -------------------------------------------------------------------------- */
+
 /*
  * We use an extra level of pointers for "cache" here to avoid problems
  * in the case where we later prune the caches.  The pointer to the
@@ -299,6 +418,7 @@ get_linear_lookup_cache (GnmFuncEvalInfo *ei,
 	pinfo->key_copy = NULL;
 
 	create_caches ();
+	purge_stale_caches ();
 
 	switch (datatype) {
 	case VALUE_STRING:
@@ -373,6 +493,7 @@ linear_lookup_cache_commit (LinearLookupInfo *pinfo)
 	total_cache_size += g_hash_table_size (pinfo->h);
 
 	g_hash_table_replace (*pinfo->cache, pinfo->key_copy, pinfo->h);
+	lookup_cache_watch (pinfo->key_copy);
 }
 
 /*
@@ -398,6 +519,7 @@ get_bisection_lookup_cache (GnmFuncEvalInfo *ei,
 	pinfo->key_copy = NULL;
 
 	create_caches ();
+	purge_stale_caches ();
 
 	/* The "&" here is for the pruning case.  */
 	switch (datatype) {
@@ -467,6 +589,7 @@ bisection_lookup_cache_commit (BisectionLookupInfo *pinfo)
 	total_cache_size += pinfo->item->n;
 
 	g_hash_table_replace (*pinfo->cache, pinfo->key_copy, pinfo->item);
+	lookup_cache_watch (pinfo->key_copy);
 }
 
 
@@ -683,6 +806,7 @@ find_index_bisection (GnmFuncEvalInfo *ei,
 	int (*comparer) (const void *,const void *);
 	LookupBisectionCacheItemElem key;
 	BisectionLookupInfo info;
+	char *key_str = NULL;
 
 	bc = get_bisection_lookup_cache (ei, data, find->v_any.type, vertical,
 					 &info);
@@ -732,11 +856,10 @@ find_index_bisection (GnmFuncEvalInfo *ei,
 	if (type == 0)
 		return wildcard_string_match (value_peek_string (find), bc);
 
-	if (stringp) {
-		char *vc = g_utf8_casefold (value_peek_string (find), -1);
-		key.u.str = g_string_chunk_insert (lookup_string_pool, vc);
-		g_free (vc);
-	} else {
+	/* The key is not kept, so it stays out of the pool.  */
+	if (stringp)
+		key.u.str = key_str = g_utf8_casefold (value_peek_string (find), -1);
+	else {
 #ifdef DEBUG_BISECTION
 		int lp;
 		for (lp = 0; lp < bc->n; lp++) {
@@ -769,7 +892,8 @@ find_index_bisection (GnmFuncEvalInfo *ei,
 			       mid + dir < bc->n &&
 			       comparer (&key, bc->data + (mid + dir)) == 0)
 				mid += dir;
-			return bc->data[mid].index;
+			res = bc->data[mid].index;
+			goto out;
 		}
 		if (type < 0)
 			c = -c; /* Reverse sorted data.  */
@@ -795,71 +919,24 @@ find_index_bisection (GnmFuncEvalInfo *ei,
 	g_printerr ("   index=%d\n", res);
 #endif
 
+out:
+	g_free (key_str);
 	return res;
 }
 
+/*
+ * The search part of find_index_x, for @key derived from @find.
+ */
 static int
-find_index_x (GnmFuncEvalInfo *ei,
-	      GnmValue const *find, GnmValue const *data,
-	      int match_mode, int search_mode, gboolean vertical)
+find_index_x_search (LookupBisectionCacheItem *bc,
+		     LookupBisectionCacheItemElem const *key,
+		     GnmValue const *find, gboolean stringp,
+		     int (*comparer) (const void *,const void *),
+		     int match_mode, int search_mode)
 {
 	int high, low, lastlow, res;
-	LookupBisectionCacheItem *bc;
-	gboolean stringp;
-	int (*comparer) (const void *,const void *);
-	LookupBisectionCacheItemElem key;
-	BisectionLookupInfo info;
 	int i;
 
-	bc = get_bisection_lookup_cache (ei, data, find->v_any.type, vertical,
-					 &info);
-	if (!bc)
-		return LOOKUP_DATA_ERROR;
-
-	stringp = VALUE_IS_STRING (find);
-	comparer = stringp ? bisection_compare_string : bisection_compare_float;
-
-	if (info.is_new) {
-		int lp, length = calc_length (data, ei->pos, vertical);
-
-		bc->data = g_new (LookupBisectionCacheItemElem, length + 1);
-
-		if (stringp)
-			protect_string_pool++;
-
-		for (lp = 0; lp < length; lp++) {
-			GnmValue const *v = get_elem (data, lp, ei->pos, vertical);
-			if (!find_compare_type_valid (find, v))
-				continue;
-
-			if (stringp) {
-				char *vc = g_utf8_casefold (value_peek_string (v), -1);
-				bc->data[bc->n].u.str = g_string_chunk_insert (lookup_string_pool, vc);
-				g_free (vc);
-			} else
-				bc->data[bc->n].u.f = value_get_as_float (v);
-
-			bc->data[bc->n].index = lp;
-			bc->n++;
-		}
-
-		bc->data = g_renew (LookupBisectionCacheItemElem,
-				    bc->data,
-				    bc->n);
-		bisection_lookup_cache_commit (&info);
-
-		if (stringp)
-			protect_string_pool--;
-	}
-
-	if (stringp) {
-		char *vc = g_utf8_casefold (value_peek_string (find), -1);
-		key.u.str = g_string_chunk_insert (lookup_string_pool, vc);
-		g_free (vc);
-	} else {
-		key.u.f = value_get_as_float (find);
-	}
-
 	if (search_mode == 2 || search_mode == -2) {
 		/* Binary search.  */
 		int type = (search_mode == 2 ? 1 : -1);
@@ -868,7 +945,7 @@ find_index_x (GnmFuncEvalInfo *ei,
 		high = bc->n - 1;
 		while (low <= high) {
 			int mid = (low + high) / 2;
-			int c = comparer (&key, bc->data + mid);
+			int c = comparer (key, bc->data + mid);
 			if (c == 0) {
 				/* Found exact match.  */
 				return bc->data[mid].index;
@@ -920,7 +997,7 @@ find_index_x (GnmFuncEvalInfo *ei,
 
 		/* Exact match.  */
 		for (i = start; i != end; i += step) {
-			if (comparer (&key, bc->data + i) == 0)
+			if (comparer (key, bc->data + i) == 0)
 				return bc->data[i].index;
 		}
 
@@ -930,7 +1007,7 @@ find_index_x (GnmFuncEvalInfo *ei,
 		/* match_mode -1 or 1: Next smaller/larger.  */
 		int best_i = -1;
 		for (i = start; i != end; i += step) {
-			int c = comparer (&key, bc->data + i);
+			int c = comparer (key, bc->data + i);
 			if (match_mode == -1 && c > 0) { /* find > data[i] */
 				if (best_i == -1 || comparer (bc->data + i, bc->data + best_i) > 0)
 					best_i = i;
@@ -946,6 +1023,72 @@ find_index_x (GnmFuncEvalInfo *ei,
 	return LOOKUP_NOT_THERE;
 }
 
+static int
+find_index_x (GnmFuncEvalInfo *ei,
+	      GnmValue const *find, GnmValue const *data,
+	      int match_mode, int search_mode, gboolean vertical)
+{
+	int res;
+	LookupBisectionCacheItem *bc;
+	gboolean stringp;
+	int (*comparer) (const void *,const void *);
+	LookupBisectionCacheItemElem key;
+	BisectionLookupInfo info;
+	char *key_str = NULL;
+
+	bc = get_bisection_lookup_cache (ei, data, find->v_any.type, vertical,
+					 &info);
+	if (!bc)
+		return LOOKUP_DATA_ERROR;
+
+	stringp = VALUE_IS_STRING (find);
+	comparer = stringp ? bisection_compare_string : bisection_compare_float;
+
+	if (info.is_new) {
+		int lp, length = calc_length (data, ei->pos, vertical);
+
+		bc->data = g_new (LookupBisectionCacheItemElem, length + 1);
+
+		if (stringp)
+			protect_string_pool++;
+
+		for (lp = 0; lp < length; lp++) {
+			GnmValue const *v = get_elem (data, lp, ei->pos, vertical);
+			if (!find_compare_type_valid (find, v))
+				continue;
+
+			if (stringp) {
+				char *vc = g_utf8_casefold (value_peek_string (v), -1);
+				bc->data[bc->n].u.str = g_string_chunk_insert (lookup_string_pool, vc);
+				g_free (vc);
+			} else
+				bc->data[bc->n].u.f = value_get_as_float (v);
+
+			bc->data[bc->n].index = lp;
+			bc->n++;
+		}
+
+		bc->data = g_renew (LookupBisectionCacheItemElem,
+				    bc->data,
+				    bc->n);
+		bisection_lookup_cache_commit (&info);
+
+		if (stringp)
+			protect_string_pool--;
+	}
+
+	/* The key is not kept, so it stays out of the pool.  */
+	if (stringp)
+		key.u.str = key_str = g_utf8_casefold (value_peek_string (find), -1);
+	else
+		key.u.f = value_get_as_float (find);
+
+	res = find_index_x_search (bc, &key, find, stringp, comparer,
+				   match_mode, search_mode);
+	g_free (key_str);
+	return res;
+}
+
 /***************************************************************************/
 
 static GnmFuncHelp const help_address[] = {
@@ -2476,14 +2619,14 @@ go_plugin_init (GOPlugin *plugin, GOCmdContext *cc)
 {
 	debug_lookup_caches = gnm_debug_flag ("lookup-caches");
 	g_signal_connect (gnm_app_get_app (), "recalc-clear-caches",
-			  G_CALLBACK (clear_caches), NULL);
+			  G_CALLBACK (purge_stale_caches), NULL);
 }
 
 G_MODULE_EXPORT void
 go_plugin_shutdown (GOPlugin *plugin, GOCmdContext *cc)
 {
 	g_signal_handlers_disconnect_by_func (gnm_app_get_app (),
-					      G_CALLBACK (clear_caches), NULL);
+					      G_CALLBACK (purge_stale_caches), NULL);
 
 	if (protect_string_pool) {
 		g_printerr ("Imbalance in string pool: %d\n", (int)protect_string_pool);
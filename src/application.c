@@ -1164,6 +1164,19 @@ gnm_app_recalc_finish (void)
 	}
 }
 
+/**
+ * gnm_app_recalc_in_progress:
+ *
+ * Returns: %TRUE between gnm_app_recalc_start and the matching
+ * gnm_app_recalc_finish.  Dependents must not be unlinked then as the
+ * recalc engine may be walking the dependent lists.
+ */
+gboolean
+gnm_app_recalc_in_progress (void)
+{
+	return app->recalc_count > 0;
+}
+
 void
 gnm_app_recalc_clear_caches (void)
 {
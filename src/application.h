@@ -30,6 +30,7 @@ void         gnm_app_sanity_check (void);
 void         gnm_app_recalc                (void);
 void         gnm_app_recalc_start          (void);
 void         gnm_app_recalc_finish         (void);
+gboolean     gnm_app_recalc_in_progress    (void);
 void         gnm_app_recalc_clear_caches   (void);
 
 /* GtkFileFilter */
@@ -41,6 +41,7 @@
 #include <stf-parse.h>
 #include <gnm-format.h>
 #include <sheet-object-cell-comment.h>
+#include <gutils.h>
 
 #include <glib/gi18n-lib.h>
 #include <locale.h>
@@ -265,6 +266,7 @@ struct paste_cell_data {
 	GnmCellPos	top_left;
 	GnmExprRelocateInfo rinfo;
 	gboolean translate_dates;
+	GnmExprSharer *sharer;
 };
 
 /**
@@ -303,6 +305,12 @@ paste_cell (int target_col, int target_row,
 				/* We must not share array expressions.  */
 				relo = gnm_expr_top_new (gnm_expr_copy (src->texpr->expr));
 			}
+			/*
+			 * Repeated pastes of the same block give many identical
+			 * relocated expressions.  Keep one copy of each.
+			 */
+			if (relo)
+				relo = gnm_expr_sharer_share (dat->sharer, relo);
 			gnm_cell_set_expr_and_value (dst, relo ? relo : src->texpr,
 						 value_dup (src->val), TRUE);
 			gnm_expr_top_unref (relo);
@@ -571,6 +579,8 @@ clipboard_paste_region (GnmCellRegion const *cr,
 
 	dat.translate_dates = cr->date_conv &&
 		!go_date_conv_equal (cr->date_conv, sheet_date_conv (pt->sheet));
+	dat.sharer = gnm_expr_sharer_new ();
+	gnm_dep_batch_link_begin ();
 
 	for (i = 0; i < repeat_horizontal ; i++)
 		for (j = 0; j < repeat_vertical ; j++) {
@@ -647,6 +657,14 @@ clipboard_paste_region (GnmCellRegion const *cr,
 					paste_object (pt, ptr->data, left, top);
 		}
 
+	gnm_dep_batch_link_end ();
+
+	if (gnm_debug_flag ("expr-sharer")) {
+		g_printerr ("Paste:\n");
+		gnm_expr_sharer_report (dat.sharer);
+	}
+	gnm_expr_sharer_unref (dat.sharer);
+
 	no_flipping = (pt->paste_flags & (PASTE_FLIP_H | PASTE_FLIP_V | PASTE_TRANSPOSE)) == 0;
 	do_col_widths =
 		no_flipping &&
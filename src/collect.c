@@ -14,6 +14,7 @@
 #include <application.h>
 #include <value.h>
 #include <cell.h>
+#include <dependent.h>
 #include <expr.h>
 #include <expr-impl.h>
 #include <expr-name.h>
@@ -22,13 +23,34 @@
 #include <sheet.h>
 #include <ranges.h>
 #include <number-match.h>
+#include <gutils.h>
 #include <goffice/goffice.h>
 #include <stdlib.h>
 #include <string.h>
 
 /* ------------------------------------------------------------------------- */
 
+/*
+ * Every cache entry is keyed by one or two ranges.  Each range gets a
+ * range watch and once that has gone stale the entries using the range
+ * are dropped.  Independently of that, the least recently used entries
+ * are evicted when the total size goes over budget.
+ */
+
 typedef struct {
+	GHashTable *owner;
+	GList *lru;
+	size_t size;
+	GnmRangeWatch *watchers[2];
+} CacheEntryHead;
+
+static void cache_entry_head_clear (CacheEntryHead *head);
+
+/* ------------------------------------------------------------------------- */
+
+typedef struct {
+	CacheEntryHead head;
+
 	/* key */
 	GnmValue *value;
 	CollectFlags flags;
@@ -42,6 +64,7 @@ typedef struct {
 static void
 single_floats_cache_entry_free (SingleFloatsCacheEntry *entry)
 {
+	cache_entry_head_clear (&entry->head);
 	value_release (entry->value);
 	value_release (entry->error);
 	g_free (entry->data);
@@ -66,6 +89,8 @@ single_floats_cache_entry_equal (const SingleFloatsCacheEntry *a,
 /* ------------------------------------------------------------------------- */
 
 typedef struct {
+	CacheEntryHead head;
+
 	/* key */
 	GnmValue *vx;
 	GnmValue *vy;
@@ -81,6 +106,7 @@ typedef struct {
 static void
 pairs_floats_cache_entry_free (PairsFloatsCacheEntry *entry)
 {
+	cache_entry_head_clear (&entry->head);
 	value_release (entry->vx);
 	value_release (entry->vy);
 	value_release (entry->error);
@@ -113,34 +139,51 @@ pairs_floats_cache_entry_equal (const PairsFloatsCacheEntry *a,
 static gulong cache_handler;
 static GHashTable *single_floats_cache;
 static GHashTable *pairs_floats_cache;
+static GQueue cache_lru = G_QUEUE_INIT;
 static size_t total_cache_size;
+static size_t cache_budget;
+static unsigned cache_watch_generation;
+static gboolean debug_collect_caches;
 
-static void
-clear_caches (void)
+static gboolean
+cb_purge_stale (G_GNUC_UNUSED gpointer key, CacheEntryHead *head,
+		G_GNUC_UNUSED gpointer user)
 {
-	if (!cache_handler)
-		return;
+	return ((head->watchers[0] &&
+		 gnm_range_watch_is_stale (head->watchers[0])) ||
+		(head->watchers[1] &&
+		 gnm_range_watch_is_stale (head->watchers[1])));
+}
 
-	g_signal_handler_disconnect (gnm_app_get_app (), cache_handler);
-	cache_handler = 0;
+/*
+ * Drop the entries whose ranges have changed since they were collected.
+ */
+static void
+purge_stale_caches (void)
+{
+	unsigned generation = gnm_range_watch_generation ();
 
-	g_hash_table_destroy (single_floats_cache);
-	single_floats_cache = NULL;
-	g_hash_table_destroy (pairs_floats_cache);
-	pairs_floats_cache = NULL;
+	if (generation == cache_watch_generation)
+		return;
 
-	total_cache_size = 0;
+	cache_watch_generation = generation;
+	g_hash_table_foreach_remove (single_floats_cache,
+				     (GHRFunc)cb_purge_stale, NULL);
+	g_hash_table_foreach_remove (pairs_floats_cache,
+				     (GHRFunc)cb_purge_stale, NULL);
 }
 
 static void
 create_caches (void)
 {
+	char const *budget;
+
 	if (cache_handler)
 		return;
 
 	cache_handler =
 		g_signal_connect (gnm_app_get_app (), "recalc-clear-caches",
-				  G_CALLBACK (clear_caches), NULL);
+				  G_CALLBACK (purge_stale_caches), NULL);
 
 	single_floats_cache = g_hash_table_new_full
 		((GHashFunc)single_floats_cache_entry_hash,
@@ -152,65 +195,128 @@ create_caches (void)
 		 (GEqualFunc)pairs_floats_cache_entry_equal,
 		 (GDestroyNotify)pairs_floats_cache_entry_free,
 		 NULL);
-
 	total_cache_size = 0;
+
+	debug_collect_caches = gnm_debug_flag ("collect-caches");
+
+	/* Size in bytes of all cached data.  */
+	budget = g_getenv ("GNM_COLLECT_CACHE_SIZE");
+	cache_budget = budget
+		? strtoul (budget, NULL, 10)
+		: GNM_DEFAULT_ROWS * 32 * sizeof (gnm_float);
 }
 
-static gboolean
-cb_prune (gpointer key, gpointer value, gpointer user)
+/* Evict least recently used entries until @extra more bytes fit.  */
+static void
+prune_caches (size_t extra)
 {
-	return TRUE;
+	while (cache_lru.tail &&
+	       total_cache_size + extra > cache_budget) {
+		CacheEntryHead *head = g_queue_peek_tail (&cache_lru);
+		if (debug_collect_caches)
+			g_printerr ("Evicting collect cache entry of size %ld.\n",
+				    (long)head->size);
+		g_hash_table_remove (head->owner, head);
+	}
 }
 
+/* ------------------------------------------------------------------------- */
+
 static void
-prune_caches (void)
+cache_entry_head_clear (CacheEntryHead *head)
 {
-	if (total_cache_size > GNM_DEFAULT_ROWS * 32) {
-		if (0) g_printerr ("Pruning collect cache from size %ld.\n",
-				   (long)total_cache_size);
-
-		total_cache_size = 0;
-		g_hash_table_foreach_remove (single_floats_cache,
-					     cb_prune,
-					     NULL);
-		g_hash_table_foreach_remove (pairs_floats_cache,
-					     cb_prune,
-					     NULL);
+	int i;
+
+	if (head->lru) {
+		g_queue_delete_link (&cache_lru, head->lru);
+		head->lru = NULL;
+		total_cache_size -= head->size;
 	}
+
+	for (i = 0; i < 2; i++) {
+		if (head->watchers[i]) {
+			gnm_range_watch_unref (head->watchers[i]);
+			head->watchers[i] = NULL;
+		}
+	}
+}
+
+/*
+ * Add an entry keyed by @r0 and, optionally, @r1 to @cache, replacing any
+ * equal entry.
+ */
+static void
+cache_entry_insert (GHashTable *cache, CacheEntryHead *head, size_t size,
+		    GnmValue const *r0, GnmValue const *r1)
+{
+	purge_stale_caches ();
+	prune_caches (size);
+
+	head->owner = cache;
+	head->size = size;
+	head->watchers[0] = gnm_range_watch_new (r0);
+	head->watchers[1] = r1 ? gnm_range_watch_new (r1) : NULL;
+
+	/*
+	 * We looked for the entry earlier and it was not there.
+	 * However, sub-calculation might have added it so be careful
+	 * to replace the not-so-old entry.
+	 * See bug 627079.
+	 */
+	g_hash_table_replace (cache, head, head);
+
+	g_queue_push_head (&cache_lru, head);
+	head->lru = cache_lru.head;
+	total_cache_size += size;
+}
+
+static void
+cache_entry_touch (CacheEntryHead *head)
+{
+	g_queue_unlink (&cache_lru, head->lru);
+	g_queue_push_head_link (&cache_lru, head->lru);
 }
 
 static SingleFloatsCacheEntry *
 get_single_floats_cache_entry (GnmValue const *value, CollectFlags flags)
 {
-	SingleFloatsCacheEntry key;
+	SingleFloatsCacheEntry key, *res;
 
 	if (flags & (COLLECT_INFO | COLLECT_IGNORE_SUBTOTAL))
 		return NULL;
 
 	create_caches ();
+	purge_stale_caches ();
 
 	key.value = (GnmValue *)value;
 	key.flags = flags;
 
-	return g_hash_table_lookup (single_floats_cache, &key);
+	res = g_hash_table_lookup (single_floats_cache, &key);
+	if (res)
+		cache_entry_touch (&res->head);
+	return res;
 }
 
 static PairsFloatsCacheEntry *
 get_pairs_floats_cache_entry (GnmValue const *vx, GnmValue const *vy,
 			      CollectFlags flags)
 {
-	PairsFloatsCacheEntry key;
+	PairsFloatsCacheEntry key, *res;
 
 	if (flags & (COLLECT_INFO | COLLECT_IGNORE_SUBTOTAL))
 		return NULL;
 
 	create_caches ();
+	purge_stale_caches ();
 
 	key.vx = (GnmValue *)vx;
 	key.vy = (GnmValue *)vy;
 	key.flags = flags;
 
-	return g_hash_table_lookup (pairs_floats_cache, &key);
+	res = g_hash_table_lookup (pairs_floats_cache, &key);
+	if (res)
+		cache_entry_touch (&res->head);
+	return res;
 }
 
 static SingleFloatsCacheEntry *
@@ -314,6 +420,17 @@ typedef struct {
 	GODateConventions const *date_conv;
 } collect_floats_t;
 
+static inline void
+collect_floats_append (collect_floats_t *cl, gnm_float x)
+{
+	if (cl->count == cl->alloc_count) {
+		cl->alloc_count = cl->alloc_count * 2 + 20;
+		cl->data = g_renew (gnm_float, cl->data, cl->alloc_count);
+	}
+
+	cl->data[cl->count++] = x;
+}
+
 static GnmValue *
 callback_function_collect (GnmEvalPos const *ep, GnmValue const *value,
 			   gboolean direct, void *closure)
@@ -424,12 +541,7 @@ callback_function_collect (GnmEvalPos const *ep, GnmValue const *value,
 		}
 	}
 
-	if (cl->count == cl->alloc_count) {
-		cl->alloc_count = cl->alloc_count * 2 + 20;
-		cl->data = g_renew (gnm_float, cl->data, cl->alloc_count);
-	}
-
-	cl->data[cl->count++] = x;
+	collect_floats_append (cl, x);
 	return NULL;
 }
 
@@ -551,8 +663,7 @@ collect_floats (int argc, GnmExprConstPtr const *argv,
 	*n = cl.count;
 
 	if (key) {
-		SingleFloatsCacheEntry *ce = g_new (SingleFloatsCacheEntry, 1);
-		SingleFloatsCacheEntry *ce2;
+		SingleFloatsCacheEntry *ce = g_new0 (SingleFloatsCacheEntry, 1);
 		ce->value = key;
 		ce->flags = keyflags;
 		ce->n = *n;
@@ -564,24 +675,10 @@ collect_floats (int argc, GnmExprConstPtr const *argv,
 			ce->data = cl.data;
 		} else
 			ce->data = go_memdup_n (cl.data, MAX (1, *n), sizeof (gnm_float));
-		prune_caches ();
-
-		// Normally the caches will exist at this point, but
-		// an explicit signal emission could have cleared them.
 		create_caches ();
-
-		/*
-		 * We looked for the entry earlier and it was not there.
-		 * However, sub-calculation might have added it so be careful
-		 * to adjust sizes and replace the not-so-old entry.
-		 * See bug 627079.
-		 */
-		ce2 = g_hash_table_lookup (single_floats_cache, ce);
-		if (ce2)
-			total_cache_size -= 1 + ce2->n;
-
-		g_hash_table_replace (single_floats_cache, ce, ce);
-		total_cache_size += 1 + *n;
+		cache_entry_insert (single_floats_cache, &ce->head,
+				    sizeof (*ce) + MAX (0, *n) * sizeof (gnm_float),
+				    key, NULL);
 	}
 	return cl.data;
 }
@@ -667,6 +764,15 @@ cb_iterate_cellrange (GnmCellIter const *iter, gpointer user)
 		return NULL;
 
 	gnm_cell_eval (cell);
+
+	/* Plain numbers for collect_floats need no evaluation position.  */
+	if (data->callback == callback_function_collect &&
+	    VALUE_IS_FLOAT (cell->value)) {
+		collect_floats_append (data->closure,
+				       value_get_as_float (cell->value));
+		return NULL;
+	}
+
 	eval_pos_init_cell (&ep, cell);
 
 	/* If we encounter an error for the strict case, short-circuit here.  */
@@ -1099,23 +1205,13 @@ collect_float_pairs (GnmValue const *vx, GnmValue const *vy,
 	if (!ce) {
 		ce = collect_float_pairs_ce (vx, vy, ep, flags);
 		if (use_cache) {
-			PairsFloatsCacheEntry *ce2;
 			ce->vx = key_x;
 			ce->vy = key_y;
 			free_keys = FALSE;
 
-			/*
-			 * We looked for the entry earlier and it was not there.
-			 * However, sub-calculation might have added it so be careful
-			 * to adjust sizes and replace the not-so-old entry.
-			 * See bug 627079.
-			 */
-			ce2 = g_hash_table_lookup (pairs_floats_cache, ce);
-			if (ce2)
-				total_cache_size -= 1 + ce2->n;
-
-			g_hash_table_replace (pairs_floats_cache, ce, ce);
-			total_cache_size += 1 + ce->n;
+			cache_entry_insert (pairs_floats_cache, &ce->head,
+					    sizeof (*ce) + 2 * MAX (0, ce->n) * sizeof (gnm_float),
+					    key_x, key_y);
 		}
 	}
 
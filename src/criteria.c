@@ -1,4 +1,8 @@
 #include <criteria.h>
+#include <dependent.h>
+#include <application.h>
+#include <ranges.h>
+#include <stdlib.h>
 
 typedef enum { CRIT_NULL, CRIT_FLOAT, CRIT_WRONGTYPE, CRIT_STRING } CritType;
 
@@ -363,6 +367,7 @@ gnm_criteria_parse (GnmValue const *crit_val, GODateConventions const *date_conv
 
 	res->iter_flags = CELL_ITER_IGNORE_BLANK;
 	res->date_conv = date_conv;
+	res->anchor_end = anchor_end;
 	res->ref_count = 1;
 
 	if (VALUE_IS_NUMBER (crit_val)) {
@@ -601,6 +606,213 @@ filter_row:
 
 /****************************************************************************/
 
+/*
+ * The *IFS functions tend to be used many times over with the same
+ * criteria ranges and only a handful of distinct criteria, so we cache
+ * the outcome of testing a criterion against a range as a bitmap.  The
+ * entries are dropped when the range changes.
+ */
+
+#define CRIT_BITS_PER_WORD 32
+#define CRIT_BITMAP_WORDS(n) (((n) + CRIT_BITS_PER_WORD - 1) / CRIT_BITS_PER_WORD)
+#define CRIT_BIT_TEST(bits,i) ((bits)[(i) / CRIT_BITS_PER_WORD] & (1u << ((i) % CRIT_BITS_PER_WORD)))
+#define CRIT_BIT_SET(bits,i) ((bits)[(i) / CRIT_BITS_PER_WORD] |= (1u << ((i) % CRIT_BITS_PER_WORD)))
+#define CRIT_BIT_CLEAR(bits,i) ((bits)[(i) / CRIT_BITS_PER_WORD] &= ~(1u << ((i) % CRIT_BITS_PER_WORD)))
+
+typedef struct {
+	GnmValue *range;
+	GnmCriteria *crit;
+	GnmRangeWatch *watch;
+	guint32 *bits;
+	size_t size;
+} CriteriaCacheEntry;
+
+static GHashTable *criteria_cache;
+static size_t criteria_cache_size;
+static size_t criteria_cache_budget;
+static unsigned criteria_cache_generation;
+
+static guint
+criteria_cache_entry_hash (CriteriaCacheEntry const *e)
+{
+	return value_hash (e->range) ^
+		(value_hash (e->crit->x) * 7) ^
+		GPOINTER_TO_UINT (e->crit->fun);
+}
+
+static gboolean
+criteria_cache_entry_equal (CriteriaCacheEntry const *a,
+			    CriteriaCacheEntry const *b)
+{
+	return (a->crit->fun == b->crit->fun &&
+		a->crit->date_conv == b->crit->date_conv &&
+		a->crit->anchor_end == b->crit->anchor_end &&
+		value_equal (a->crit->x, b->crit->x) &&
+		value_equal (a->range, b->range));
+}
+
+static void
+criteria_cache_entry_free (CriteriaCacheEntry *e)
+{
+	criteria_cache_size -= e->size;
+	gnm_range_watch_unref (e->watch);
+	gnm_criteria_unref (e->crit);
+	value_release (e->range);
+	g_free (e->bits);
+	g_free (e);
+}
+
+static gboolean
+cb_criteria_cache_purge_stale (CriteriaCacheEntry *e,
+			       G_GNUC_UNUSED gpointer value,
+			       G_GNUC_UNUSED gpointer user)
+{
+	return gnm_range_watch_is_stale (e->watch);
+}
+
+static void
+criteria_cache_purge_stale (void)
+{
+	unsigned generation = gnm_range_watch_generation ();
+
+	if (generation == criteria_cache_generation)
+		return;
+
+	criteria_cache_generation = generation;
+	g_hash_table_foreach_remove (criteria_cache,
+				     (GHRFunc)cb_criteria_cache_purge_stale,
+				     NULL);
+}
+
+static void
+criteria_cache_create (void)
+{
+	char const *budget;
+
+	if (criteria_cache)
+		return;
+
+	criteria_cache = g_hash_table_new_full
+		((GHashFunc)criteria_cache_entry_hash,
+		 (GEqualFunc)criteria_cache_entry_equal,
+		 (GDestroyNotify)criteria_cache_entry_free,
+		 NULL);
+	criteria_cache_generation = gnm_range_watch_generation ();
+
+	g_signal_connect (gnm_app_get_app (), "recalc-clear-caches",
+			  G_CALLBACK (criteria_cache_purge_stale), NULL);
+
+	/* Size in bytes of all cached bitmaps.  */
+	budget = g_getenv ("GNM_CRITERIA_CACHE_SIZE");
+	criteria_cache_budget = budget
+		? strtoul (budget, NULL, 10)
+		: GNM_DEFAULT_ROWS * 32;
+}
+
+/*
+ * Returns the range that @v covers if it is worth caching criteria
+ * outcomes for it.
+ */
+static GnmValue *
+criteria_cache_key (GnmValue const *v, GnmEvalPos const *ep)
+{
+	Sheet *start_sheet, *end_sheet;
+	GnmRange r;
+	const int min_size = 25;
+
+	if (!VALUE_IS_CELLRANGE (v))
+		return NULL;
+
+	gnm_rangeref_normalize (&v->v_range.cell, ep,
+				&start_sheet, &end_sheet, &r);
+	if (start_sheet != end_sheet ||
+	    range_width (&r) * range_height (&r) < min_size)
+		return NULL;
+
+	return value_new_cellrange_r (start_sheet, &r);
+}
+
+typedef struct {
+	GnmCriteria *crit;
+	GnmRange const *r;
+	guint32 *bits;
+} CriteriaBitmapClosure;
+
+static GnmValue *
+cb_criteria_bitmap (GnmCellIter const *iter, CriteriaBitmapClosure *cl)
+{
+	int i = (iter->pp.eval.row - cl->r->start.row) * range_width (cl->r) +
+		(iter->pp.eval.col - cl->r->start.col);
+
+	if (cl->crit->fun (gnm_cell_eval (iter->cell), cl->crit))
+		CRIT_BIT_SET (cl->bits, i);
+	else
+		CRIT_BIT_CLEAR (cl->bits, i);
+
+	return NULL;
+}
+
+/*
+ * AND the outcome of testing @crit against every cell of @range, row
+ * by row, into @mask.
+ */
+static void
+criteria_cache_apply (GnmValue const *range, GnmCriteria *crit,
+		      guint32 *mask, size_t words)
+{
+	CriteriaCacheEntry key, *e;
+	CriteriaBitmapClosure cl;
+	GnmValue *empty;
+	GnmRange r;
+	Sheet *sheet = range->v_range.cell.a.sheet;
+	size_t ui;
+
+	criteria_cache_create ();
+	criteria_cache_purge_stale ();
+
+	key.range = (GnmValue *)range;
+	key.crit = crit;
+	e = g_hash_table_lookup (criteria_cache, &key);
+	if (e) {
+		for (ui = 0; ui < words; ui++)
+			mask[ui] &= e->bits[ui];
+		return;
+	}
+
+	/*
+	 * Cells that do not exist are all alike, so test an empty value
+	 * once and only look at the cells we have.
+	 */
+	empty = value_new_empty ();
+	cl.bits = g_new (guint32, words);
+	memset (cl.bits, crit->fun (empty, crit) ? 0xff : 0,
+		words * sizeof (guint32));
+	value_release (empty);
+
+	range_init_value (&r, range);
+	cl.crit = crit;
+	cl.r = &r;
+	sheet_foreach_cell_in_range (sheet, CELL_ITER_IGNORE_NONEXISTENT, &r,
+				     (CellIterFunc)cb_criteria_bitmap, &cl);
+
+	for (ui = 0; ui < words; ui++)
+		mask[ui] &= cl.bits[ui];
+
+	/* Evaluating the cells may have run other *IFS calls.  */
+	criteria_cache_purge_stale ();
+	if (criteria_cache_size + words * sizeof (guint32) > criteria_cache_budget)
+		g_hash_table_remove_all (criteria_cache);
+
+	e = g_new (CriteriaCacheEntry, 1);
+	e->range = value_dup (range);
+	e->crit = gnm_criteria_ref (crit);
+	e->watch = gnm_range_watch_new (range);
+	e->bits = cl.bits;
+	e->size = words * sizeof (guint32);
+	criteria_cache_size += e->size;
+	g_hash_table_replace (criteria_cache, e, e);
+}
+
 /**
  * gnm_criteria_ifs_func:
  * @data: (element-type GnmValue):
@@ -628,6 +840,9 @@ gnm_criteria_ifs_func (GPtrArray *data, GPtrArray *crits, GnmValue const *vals,
 	gnm_float *xs = NULL;
 	GnmValue *res = NULL;
 	gnm_float fres;
+	guint32 *mask = NULL;
+	gboolean *cached;
+	size_t i, n, words;
 
 	g_return_val_if_fail (data->len == crits->len, NULL);
 
@@ -647,44 +862,80 @@ gnm_criteria_ifs_func (GPtrArray *data, GPtrArray *crits, GnmValue const *vals,
 			return value_new_error_VALUE (ep);
 	}
 
-	for (y = 0; y < sy; y++) {
-		for (x = 0; x < sx; x++) {
-			GnmValue const *v;
-			gboolean match = TRUE;
+	/*
+	 * Criteria over ranges of a decent size are answered from the
+	 * bitmap cache; the rest are tested cell by cell below.
+	 */
+	n = (size_t)sx * sy;
+	words = CRIT_BITMAP_WORDS (n);
+	cached = g_new0 (gboolean, crits->len);
+	for (ui = 0; ui < data->len; ui++) {
+		GnmValue const *datai = g_ptr_array_index (data, ui);
+		GnmValue *key = criteria_cache_key (datai, ep);
+		if (!key)
+			continue;
+		if (!mask) {
+			mask = g_new (guint32, words);
+			memset (mask, 0xff, words * sizeof (guint32));
+		}
+		criteria_cache_apply (key, g_ptr_array_index (crits, ui),
+				      mask, words);
+		cached[ui] = TRUE;
+		value_release (key);
+	}
 
-			for (ui = 0; match && ui < crits->len; ui++) {
-				GnmCriteria *crit = g_ptr_array_index (crits, ui);
-				GnmValue const *datai = g_ptr_array_index (data, ui);
-				v = value_area_get_x_y (datai, x, y, ep);
+	for (i = 0; i < n; i++) {
+		GnmValue const *v;
+		gboolean match = TRUE;
 
-				match = crit->fun (v, crit);
-			}
-			if (!match)
-				continue;
+		if (mask && !CRIT_BIT_TEST (mask, i)) {
+			/* Skip the rest of an all-clear word.  */
+			if (!mask[i / CRIT_BITS_PER_WORD])
+				i |= CRIT_BITS_PER_WORD - 1;
+			continue;
+		}
 
-			// Match.  Maybe collect the data point.
+		x = i % sx;
+		y = i / sx;
 
-			v = value_area_get_x_y (vals, x, y, ep);
-			if ((flags & COLLECT_IGNORE_STRINGS) && VALUE_IS_STRING (v))
-				continue;
-			if ((flags & COLLECT_IGNORE_BOOLS) && VALUE_IS_BOOLEAN (v))
-				continue;
-			if ((flags & COLLECT_IGNORE_BLANKS) && VALUE_IS_EMPTY (v))
-				continue;
-			if ((flags & COLLECT_IGNORE_ERRORS) && VALUE_IS_ERROR (v))
+		for (ui = 0; match && ui < crits->len; ui++) {
+			GnmCriteria *crit;
+			GnmValue const *datai;
+
+			if (cached[ui])
 				continue;
 
-			if (VALUE_IS_ERROR (v)) {
-				res = value_dup (v);
-				goto out;
-			}
+			crit = g_ptr_array_index (crits, ui);
+			datai = g_ptr_array_index (data, ui);
+			v = value_area_get_x_y (datai, x, y, ep);
 
-			if (N >= nalloc) {
-				nalloc = (2 * nalloc) + 100;
-				xs = g_renew (gnm_float, xs, nalloc);
-			}
-			xs[N++] = value_get_as_float (v);
+			match = crit->fun (v, crit);
+		}
+		if (!match)
+			continue;
+
+		// Match.  Maybe collect the data point.
+
+		v = value_area_get_x_y (vals, x, y, ep);
+		if ((flags & COLLECT_IGNORE_STRINGS) && VALUE_IS_STRING (v))
+			continue;
+		if ((flags & COLLECT_IGNORE_BOOLS) && VALUE_IS_BOOLEAN (v))
+			continue;
+		if ((flags & COLLECT_IGNORE_BLANKS) && VALUE_IS_EMPTY (v))
+			continue;
+		if ((flags & COLLECT_IGNORE_ERRORS) && VALUE_IS_ERROR (v))
+			continue;
+
+		if (VALUE_IS_ERROR (v)) {
+			res = value_dup (v);
+			goto out;
+		}
+
+		if (N >= nalloc) {
+			nalloc = (2 * nalloc) + 100;
+			xs = g_renew (gnm_float, xs, nalloc);
 		}
+		xs[N++] = value_get_as_float (v);
 	}
 
 	if (fun (xs, N, &fres)) {
@@ -694,6 +945,8 @@ gnm_criteria_ifs_func (GPtrArray *data, GPtrArray *crits, GnmValue const *vals,
 
 out:
 	g_free (xs);
+	g_free (mask);
+	g_free (cached);
 	return res;
 }
 
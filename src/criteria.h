@@ -27,6 +27,7 @@ struct _GnmCriteria {
 	GODateConventions const *date_conv;
 	GORegexp rx;
 	gboolean has_rx;
+	gboolean anchor_end;
 	unsigned ref_count; /* for boxed type */
 };
 GType   gnm_criteria_get_type (void);
@@ -54,25 +54,20 @@ typedef enum {
 
 /* ------------------------------------------------------------------------- */
 
-#ifndef USE_POOLS
-#define USE_POOLS 0
-#endif
-
-#if USE_POOLS
-static GOMemChunk *micro_few_pool;
-static GOMemChunk *cset_pool;
-#define CHUNK_ALLOC(T,p) ((T*)go_mem_chunk_alloc (p))
-#define CHUNK_FREE(p,v) go_mem_chunk_free ((p), (v))
-#define MICRO_HASH_FEW 3 /* Odd and small. */
-#define NEW_FEW CHUNK_ALLOC (gpointer, micro_few_pool)
-#define FREE_FEW(p) CHUNK_FREE (micro_few_pool, p)
-#else
-#define CHUNK_ALLOC(T,c) g_slice_new (T)
-#define CHUNK_FREE(p,v) g_slice_free1 (sizeof(*v),(v))
+/*
+ * The sets of dependents hanging off each DependencySingle and
+ * DependencyRange are allocated from pools owned by the container, so
+ * they can be released in one go with it.
+ */
 #define MICRO_HASH_FEW 4 /* Even and small. */
-#define NEW_FEW (gpointer *)g_slice_alloc (MICRO_HASH_FEW * sizeof (gpointer))
-#define FREE_FEW(p) g_slice_free1 (MICRO_HASH_FEW * sizeof (gpointer), p)
-#endif
+#define NEW_FEW(deps) \
+	((deps)->few_count++, (gpointer *)go_mem_chunk_alloc ((deps)->few_pool))
+#define FREE_FEW(deps,p) \
+	((deps)->few_count--, go_mem_chunk_free ((deps)->few_pool, (p)))
+#define NEW_CSET(deps) \
+	((deps)->cset_count++, (CSet *)go_mem_chunk_alloc ((deps)->cset_pool))
+#define FREE_CSET(deps,p) \
+	((deps)->cset_count--, go_mem_chunk_free ((deps)->cset_pool, (p)))
 
 /* ------------------------------------------------------------------------- */
 /* Maps between row numbers and bucket numbers.  */
@@ -161,22 +156,22 @@ cset_find (CSet *list, gpointer datum)
 #endif
 
 static void
-cset_free (CSet *list)
+cset_free (GnmDepContainer *deps, CSet *list)
 {
         while (list) {
                 CSet *next = list->next;
-                CHUNK_FREE (cset_pool, list);
+                FREE_CSET (deps, list);
                 list = next;
         }
 }
 
 /* NOTE: takes reference.  */
 static void
-cset_insert (CSet **list, gpointer datum)
+cset_insert (GnmDepContainer *deps, CSet **list, gpointer datum)
 {
 	CSet *cs = *list;
         if (cs == NULL || cs->count == CSET_SEGMENT_SIZE) {
-                CSet *h = *list = CHUNK_ALLOC (CSet, cset_pool);
+                CSet *h = *list = NEW_CSET (deps);
                 h->next = cs;
                 h->count = 1;
 		h->data[0] = datum;
@@ -186,7 +181,7 @@ cset_insert (CSet **list, gpointer datum)
 
 /* NOTE: takes reference.  Returns %TRUE if datum was already present.  */
 static gboolean
-cset_insert_checked (CSet **list, gpointer datum)
+cset_insert_checked (GnmDepContainer *deps, CSet **list, gpointer datum)
 {
 	CSet *cs = *list;
 	CSet *nonfull = NULL;
@@ -204,14 +199,14 @@ cset_insert_checked (CSet **list, gpointer datum)
 	if (nonfull)
 		nonfull->data[nonfull->count++] = datum;
 	else
-		cset_insert (list, datum);
+		cset_insert (deps, list, datum);
         return FALSE;
 }
 
 
 /* NOTE: takes reference.  Returns %TRUE if removed.  */
 static gboolean
-cset_remove (CSet **list, gpointer datum)
+cset_remove (GnmDepContainer *deps, CSet **list, gpointer datum)
 {
         CSet *l, *last = NULL;
 
@@ -226,7 +221,7 @@ cset_remove (CSet **list, gpointer datum)
                                                 last->next = l->next;
                                         else
                                                 *list = l->next;
-                                        CHUNK_FREE (cset_pool, l);
+                                        FREE_CSET (deps, l);
                                 } else
 					l->data[i] = l->data[l->count];
                                 return TRUE;
@@ -347,17 +342,6 @@ dependent_types_init (void)
 	g_ptr_array_add	(dep_classes, (gpointer)&dynamic_dep_class);
 	g_ptr_array_add	(dep_classes, (gpointer)&name_dep_class);
 	g_ptr_array_add	(dep_classes, (gpointer)&managed_dep_class);
-
-#if USE_POOLS
-	micro_few_pool =
-		go_mem_chunk_new ("micro few pool",
-				  MICRO_HASH_FEW * sizeof (gpointer),
-				  16 * 1024 - 128);
-	cset_pool =
-		go_mem_chunk_new ("cset pool",
-				  sizeof (CSet),
-				  16 * 1024 - 128);
-#endif
 }
 
 void
@@ -366,13 +350,6 @@ dependent_types_shutdown (void)
 	g_return_if_fail (dep_classes != NULL);
 	g_ptr_array_free (dep_classes, TRUE);
 	dep_classes = NULL;
-
-#if USE_POOLS
-	go_mem_chunk_destroy (micro_few_pool, FALSE);
-	micro_few_pool = NULL;
-	go_mem_chunk_destroy (cset_pool, FALSE);
-	cset_pool = NULL;
-#endif
 }
 
 /**
@@ -397,15 +374,117 @@ dependent_type_register (GnmDependentClass const *klass)
 	return res;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * The dependents of a container are kept in a double-linked list.  Those
+ * that need recalculation are moved to the front of the list, in the order
+ * in which they were queued, and flagged DEPENDENT_QUEUED.  queued_tail
+ * points to the last of them.  That way workbook_recalc only has to look
+ * at the queued dependents instead of every dependent of every sheet.
+ */
+
+static void
+dep_list_remove (GnmDepContainer *deps, GnmDependent *dep)
+{
+	if (deps->head == dep)
+		deps->head = dep->next_dep;
+	if (deps->tail == dep)
+		deps->tail = dep->prev_dep;
+	if (deps->queued_tail == dep)
+		deps->queued_tail = dep->prev_dep;
+	if (dep->next_dep)
+		dep->next_dep->prev_dep = dep->prev_dep;
+	if (dep->prev_dep)
+		dep->prev_dep->next_dep = dep->next_dep;
+}
+
+/* Insert @dep after @after, or first in the list if @after is NULL.  */
+static void
+dep_list_insert_after (GnmDepContainer *deps, GnmDependent *after,
+		       GnmDependent *dep)
+{
+	dep->prev_dep = after;
+	dep->next_dep = after ? after->next_dep : deps->head;
+	if (dep->next_dep)
+		dep->next_dep->prev_dep = dep;
+	else
+		deps->tail = dep;
+	if (after)
+		after->next_dep = dep;
+	else
+		deps->head = dep;
+}
+
+/* Bumped whenever a dependent joins a recalc queue.  */
+static unsigned dep_queue_stamp;
+
+static void
+dep_list_queue (GnmDepContainer *deps, GnmDependent *dep)
+{
+	dep_list_remove (deps, dep);
+	dep_list_insert_after (deps, deps->queued_tail, dep);
+	deps->queued_tail = dep;
+	dep->flags |= DEPENDENT_QUEUED;
+}
+
+/*
+ * dep_list_requeue:
+ * @deps: dependency container
+ *
+ * Empties the recalc queue, keeping only the dependents that still need
+ * recalculation.  Their order is preserved.
+ */
+static void
+dep_list_requeue (GnmDepContainer *deps)
+{
+	GnmDependent *dep, *end;
+
+	if (!deps->queued_tail)
+		return;
+
+	end = deps->queued_tail->next_dep;
+	deps->queued_tail = NULL;
+	for (dep = deps->head; dep != end; ) {
+		GnmDependent *next = dep->next_dep;
+		dep->flags &= ~DEPENDENT_QUEUED;
+		if (dependent_needs_recalc (dep))
+			dep_list_queue (deps, dep);
+		dep = next;
+	}
+}
+
 /*
  * dependent_flag_recalc:
  * @dep: the dependent that contains the expression needing recomputation.
  *
- * Marks @dep as needing recalculation
+ * Marks @dep as needing recalculation and, if it is linked, queues it
+ * in its container.
  * NOTE : it does NOT recursively dirty dependencies.
  */
-#define dependent_flag_recalc(dep) \
-  do { (dep)->flags |= DEPENDENT_NEEDS_RECALC; } while (0)
+static guint range_watch_dep_type;
+static void range_watch_mark_stale (GnmRangeWatch *w);
+
+static inline void
+dependent_flag_recalc (GnmDependent *dep)
+{
+	/*
+	 * A range watch is flagged when the cells it watches are about to
+	 * be recomputed without being marked changed, as by a full recalc.
+	 * It will not hear of later changes until it has been evaluated,
+	 * so give up on the range now.
+	 */
+	if (G_UNLIKELY (range_watch_dep_type != 0 &&
+			dependent_type (dep) == range_watch_dep_type))
+		range_watch_mark_stale ((GnmRangeWatch *)dep);
+
+	dep->flags |= DEPENDENT_NEEDS_RECALC;
+	if (!(dep->flags & DEPENDENT_QUEUED) &&
+	    dependent_is_linked (dep) &&
+	    dep->sheet->deps) {
+		dep_list_queue (dep->sheet->deps, dep);
+		dep_queue_stamp++;
+	}
+}
 
 /**
  * dependent_changed:
@@ -589,13 +668,13 @@ typedef struct {
 #define MICRO_HASH_hash(key) ((guint)GPOINTER_TO_UINT(key))
 
 static void
-micro_hash_many_to_few (MicroHash *hash_table)
+micro_hash_many_to_few (GnmDepContainer *deps, MicroHash *hash_table)
 {
 	CSet **buckets = hash_table->u.many;
 	int nbuckets = hash_table->num_buckets;
 	int i = 0;
 
-	hash_table->u.few = NEW_FEW;
+	hash_table->u.few = NEW_FEW (deps);
 
 	while (nbuckets-- > 0 ) {
 		gpointer datum;
@@ -603,14 +682,15 @@ micro_hash_many_to_few (MicroHash *hash_table)
 		CSET_FOREACH (buckets[nbuckets], datum, {
 			hash_table->u.few[i++] = datum;
 		});
-		cset_free (buckets[nbuckets]);
+		cset_free (deps, buckets[nbuckets]);
 	}
 
 	g_free (buckets);
 }
 
 static void
-micro_hash_many_resize (MicroHash *hash_table, int new_nbuckets)
+micro_hash_many_resize (GnmDepContainer *deps, MicroHash *hash_table,
+			int new_nbuckets)
 {
 	CSet **buckets = hash_table->u.many;
 	int nbuckets = hash_table->num_buckets;
@@ -624,9 +704,9 @@ micro_hash_many_resize (MicroHash *hash_table, int new_nbuckets)
 
 		CSET_FOREACH (buckets[nbuckets], datum, {
 			guint bucket = MICRO_HASH_hash (datum) % new_nbuckets;
-			cset_insert (&(new_buckets[bucket]), datum);
+			cset_insert (deps, &(new_buckets[bucket]), datum);
 		});
-		cset_free (buckets[nbuckets]);
+		cset_free (deps, buckets[nbuckets]);
 	}
 	g_free (buckets);
 
@@ -660,7 +740,7 @@ micro_hash_many_resize (MicroHash *hash_table, int new_nbuckets)
 
 
 static void
-micro_hash_few_to_many (MicroHash *hash_table)
+micro_hash_few_to_many (GnmDepContainer *deps, MicroHash *hash_table)
 {
 	int nbuckets = hash_table->num_buckets = MICRO_HASH_MIN_SIZE;
 	CSet **buckets = g_new0 (CSet *, nbuckets);
@@ -669,16 +749,16 @@ micro_hash_few_to_many (MicroHash *hash_table)
 	for (i = 0; i < hash_table->num_elements; i++) {
 		gpointer datum = hash_table->u.few[i];
 		guint bucket = MICRO_HASH_hash (datum) % nbuckets;
-		cset_insert (&(buckets[bucket]), datum);
+		cset_insert (deps, &(buckets[bucket]), datum);
 	}
-	FREE_FEW (hash_table->u.few);
+	FREE_FEW (deps, hash_table->u.few);
 	hash_table->u.many = buckets;
 }
 
 
 
 static void
-micro_hash_insert (MicroHash *hash_table, gpointer key)
+micro_hash_insert (GnmDepContainer *deps, MicroHash *hash_table, gpointer key)
 {
 	int N = hash_table->num_elements;
 
@@ -691,7 +771,7 @@ micro_hash_insert (MicroHash *hash_table, gpointer key)
 		if (key == key0)
 			return;
 		/* one --> few */
-		hash_table->u.few = NEW_FEW;
+		hash_table->u.few = NEW_FEW (deps);
 		hash_table->u.few[0] = key0;
 		hash_table->u.few[1] = key;
 		memset (hash_table->u.few + 2, 0, (MICRO_HASH_FEW - 2) * sizeof (gpointer));
@@ -705,9 +785,9 @@ micro_hash_insert (MicroHash *hash_table, gpointer key)
 		if (N == MICRO_HASH_FEW) {
 			guint bucket;
 
-			micro_hash_few_to_many (hash_table);
+			micro_hash_few_to_many (deps, hash_table);
 			bucket = MICRO_HASH_hash (key) % hash_table->num_buckets;
-			cset_insert (&(hash_table->u.many[bucket]), key);
+			cset_insert (deps, &(hash_table->u.many[bucket]), key);
 		} else
 			hash_table->u.few[N] = key;
 	} else {
@@ -715,7 +795,7 @@ micro_hash_insert (MicroHash *hash_table, gpointer key)
 		guint bucket = MICRO_HASH_hash (key) % nbuckets;
 		CSet **buckets = hash_table->u.many;
 
-		if (cset_insert_checked (&(buckets[bucket]), key))
+		if (cset_insert_checked (deps, &(buckets[bucket]), key))
 			return;
 
 		if (N > CSET_SEGMENT_SIZE * nbuckets &&
@@ -723,15 +803,39 @@ micro_hash_insert (MicroHash *hash_table, gpointer key)
 			int new_nbuckets = g_spaced_primes_closest (N / (CSET_SEGMENT_SIZE / 2));
 			if (new_nbuckets > MICRO_HASH_MAX_SIZE)
 				new_nbuckets = MICRO_HASH_MAX_SIZE;
-			micro_hash_many_resize (hash_table, new_nbuckets);
+			micro_hash_many_resize (deps, hash_table, new_nbuckets);
 		}
 	}
 
 	hash_table->num_elements++;
 }
 
+/*
+ * Like micro_hash_insert for each of @keys, but sizes the hash once for
+ * all of them instead of growing it step by step.
+ */
 static void
-micro_hash_remove (MicroHash *hash_table, gpointer key)
+micro_hash_insert_many (GnmDepContainer *deps, MicroHash *hash_table,
+			gpointer const *keys, int n)
+{
+	int i = 0;
+
+	while (i < n && hash_table->num_elements <= MICRO_HASH_FEW)
+		micro_hash_insert (deps, hash_table, keys[i++]);
+
+	if (i < n) {
+		int N = hash_table->num_elements + (n - i);
+		int nbuckets = g_spaced_primes_closest (N / (CSET_SEGMENT_SIZE / 2));
+		nbuckets = MIN (nbuckets, (int)MICRO_HASH_MAX_SIZE);
+		if (nbuckets > hash_table->num_buckets)
+			micro_hash_many_resize (deps, hash_table, nbuckets);
+		while (i < n)
+			micro_hash_insert (deps, hash_table, keys[i++]);
+	}
+}
+
+static void
+micro_hash_remove (GnmDepContainer *deps, MicroHash *hash_table, gpointer key)
 {
 	int N = hash_table->num_elements;
 	guint bucket;
@@ -758,7 +862,7 @@ micro_hash_remove (MicroHash *hash_table, gpointer key)
 					return;
 				/* few -> one */
 				key = hash_table->u.few[0];
-				FREE_FEW (hash_table->u.few);
+				FREE_FEW (deps, hash_table->u.few);
 				hash_table->u.one = key;
 				return;
 			}
@@ -766,11 +870,11 @@ micro_hash_remove (MicroHash *hash_table, gpointer key)
 	}
 
 	bucket = MICRO_HASH_hash (key) % hash_table->num_buckets;
-	if (cset_remove (&(hash_table->u.many[bucket]), key)) {
+	if (cset_remove (deps, &(hash_table->u.many[bucket]), key)) {
 		hash_table->num_elements--;
 
 		if (hash_table->num_elements <= MICRO_HASH_FEW)
-			micro_hash_many_to_few (hash_table);
+			micro_hash_many_to_few (deps, hash_table);
 		else {
 			/* Maybe resize? */
 		}
@@ -780,18 +884,18 @@ micro_hash_remove (MicroHash *hash_table, gpointer key)
 
 
 static void
-micro_hash_release (MicroHash *hash_table)
+micro_hash_release (GnmDepContainer *deps, MicroHash *hash_table)
 {
 	int N = hash_table->num_elements;
 
 	if (N <= 1)
 		; /* Nothing */
 	else if (N <= MICRO_HASH_FEW)
-		FREE_FEW (hash_table->u.few);
+		FREE_FEW (deps, hash_table->u.few);
 	else {
 		guint i = hash_table->num_buckets;
 		while (i-- > 0)
-			cset_free (hash_table->u.many[i]);
+			cset_free (deps, hash_table->u.many[i]);
 		g_free (hash_table->u.many);
 	}
 	hash_table->num_elements = 0;
@@ -799,6 +903,20 @@ micro_hash_release (MicroHash *hash_table)
 	hash_table->u.one = NULL;
 }
 
+/*
+ * Like micro_hash_release, but for use when the container's pools are
+ * about to be destroyed.  Only the bucket array lives outside them.
+ */
+static void
+micro_hash_drop (MicroHash *hash_table)
+{
+	if (hash_table->num_elements > MICRO_HASH_FEW)
+		g_free (hash_table->u.many);
+	hash_table->num_elements = 0;
+	hash_table->num_buckets = 1;
+	hash_table->u.one = NULL;
+}
+
 static void
 micro_hash_init (MicroHash *hash_table, gpointer key)
 {
@@ -883,6 +1001,497 @@ deprange_equal (DependencyRange const *r1, DependencyRange const *r2)
 	return range_equal (&(r1->range), &(r2->range));
 }
 
+/* ------------------------------------------------------------------------- */
+
+/*
+ * A bucket of range_hash can hold many distinct ranges side by side, for
+ * example one SUM per column.  To find those touching a cell without
+ * looking at every one, we index the bucket: the ranges sorted by
+ * start column, viewed as an implicit balanced tree in which each node
+ * knows the largest end column below it.  That prunes everything that
+ * ends before, or starts after, the columns we are looking for.
+ *
+ * The index is rebuilt from scratch, and lazily, after the set of keys
+ * changes.  Small buckets, and buckets that keep changing between
+ * lookups, are simply scanned.
+ */
+#define RANGE_INDEX_MIN_SIZE 32
+#define RANGE_INDEX_MIN_QUERIES 4
+
+typedef struct {
+	int n;
+	int queries;	/* Scans since the keys last changed.  */
+	DependencyRange **items;
+	int *max_end;
+} RangeIndex;
+
+static void
+range_index_invalidate (GnmDepContainer *deps, int b)
+{
+	RangeIndex *idx = deps->range_index[b];
+
+	if (idx == NULL)
+		return;
+	g_free (idx->items);
+	g_free (idx->max_end);
+	idx->items = NULL;
+	idx->max_end = NULL;
+	idx->n = 0;
+	idx->queries = 0;
+}
+
+static void
+range_index_free (GnmDepContainer *deps, int b)
+{
+	range_index_invalidate (deps, b);
+	g_free (deps->range_index[b]);
+	deps->range_index[b] = NULL;
+}
+
+static int
+cb_range_index_cmp (void const *a, void const *b)
+{
+	DependencyRange const *ra = *(DependencyRange const **)a;
+	DependencyRange const *rb = *(DependencyRange const **)b;
+	return ra->range.start.col - rb->range.start.col;
+}
+
+static int
+range_index_fill (RangeIndex *idx, int lo, int hi)
+{
+	int mid, m;
+
+	if (lo >= hi)
+		return -1;
+
+	mid = (lo + hi) / 2;
+	m = idx->items[mid]->range.end.col;
+	m = MAX (m, range_index_fill (idx, lo, mid));
+	m = MAX (m, range_index_fill (idx, mid + 1, hi));
+	idx->max_end[mid] = m;
+	return m;
+}
+
+static void
+range_index_build (RangeIndex *idx, GHashTable *hash)
+{
+	GHashTableIter hiter;
+	gpointer key;
+	int i = 0;
+
+	idx->n = g_hash_table_size (hash);
+	idx->items = g_new (DependencyRange *, idx->n);
+	idx->max_end = g_new (int, idx->n);
+
+	g_hash_table_iter_init (&hiter, hash);
+	while (g_hash_table_iter_next (&hiter, &key, NULL))
+		idx->items[i++] = key;
+	qsort (idx->items, idx->n, sizeof (DependencyRange *),
+	       cb_range_index_cmp);
+	range_index_fill (idx, 0, idx->n);
+}
+
+static void
+range_index_search (RangeIndex const *idx, int lo, int hi,
+		    GnmRange const *r, GPtrArray *res)
+{
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		DependencyRange *dr;
+
+		/* Nothing here reaches as far right as r.  */
+		if (idx->max_end[mid] < r->start.col)
+			return;
+
+		range_index_search (idx, lo, mid, r, res);
+
+		/* This and everything after it starts right of r.  */
+		dr = idx->items[mid];
+		if (dr->range.start.col > r->end.col)
+			return;
+
+		if (range_overlap (&dr->range, r))
+			g_ptr_array_add (res, dr);
+		lo = mid + 1;
+	}
+}
+
+/*
+ * Adds to @res the DependencyRanges in bucket @b that overlap @r.
+ */
+static void
+range_index_query (GnmDepContainer *deps, int b, GnmRange const *r,
+		   GPtrArray *res)
+{
+	GHashTable *hash = deps->range_hash[b];
+	RangeIndex *idx;
+
+	if (hash == NULL)
+		return;
+
+	idx = deps->range_index[b];
+	if (idx == NULL)
+		idx = deps->range_index[b] = g_new0 (RangeIndex, 1);
+
+	if (idx->items == NULL &&
+	    (g_hash_table_size (hash) < RANGE_INDEX_MIN_SIZE ||
+	     ++idx->queries < RANGE_INDEX_MIN_QUERIES)) {
+		GHashTableIter hiter;
+		gpointer key;
+
+		g_hash_table_iter_init (&hiter, hash);
+		while (g_hash_table_iter_next (&hiter, &key, NULL)) {
+			DependencyRange *dr = key;
+			if (range_overlap (&dr->range, r))
+				g_ptr_array_add (res, dr);
+		}
+		return;
+	}
+
+	if (idx->items == NULL)
+		range_index_build (idx, hash);
+	range_index_search (idx, 0, idx->n, r, res);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Filling down =SUM($A$1:A1) produces ranges that all start at A1 and
+ * end one row further down each time.  Split over the buckets, every
+ * one of them would be entered into every bucket above its end.
+ *
+ * Instead, once enough ranges share their top-left corner and columns,
+ * we keep them together as a RunningRange: one DependencyRange per
+ * distinct end row, held in a hash for linking and unlinking and in an
+ * array sorted by end row for lookups.  A cell then hits exactly the
+ * tail of the array that ends at or below it.
+ *
+ * Ranges that were linked before the family got going stay in the
+ * buckets; both places are searched.
+ *
+ * A member that loses its last dependent stays in the sorted array,
+ * empty, until the array is rebuilt.  That way relocating a block of
+ * formulas, which unlinks them one by one while looking things up, does
+ * not force a rebuild every time.
+ *
+ * Families that are in use are also indexed by the columns they cover,
+ * so a lookup only considers the families in its own columns.
+ */
+#define RUNNING_MIN_RANGES 8
+
+typedef struct {
+	/* start.row, start.col and end.col are the key.  end.row is
+	 * the largest end row ever seen.  */
+	GnmRange range;
+	int candidates;		/* Ranges with this anchor in the buckets.  */
+	GHashTable *ends;	/* NULL until enough ranges have been seen.  */
+	GPtrArray *sorted;	/* Values of ends sorted by end row, or NULL.  */
+	guint dead;		/* Empty members left in sorted.  */
+} RunningRange;
+
+static guint
+running_hash (RunningRange const *rr)
+{
+	guint a = rr->range.start.row;
+	guint c = rr->range.start.col;
+	guint d = rr->range.end.col;
+
+	return (((a << 8) + c) << 8) + d;
+}
+
+static gint
+running_equal (RunningRange const *rr1, RunningRange const *rr2)
+{
+	return rr1->range.start.row == rr2->range.start.row &&
+		rr1->range.start.col == rr2->range.start.col &&
+		rr1->range.end.col == rr2->range.end.col;
+}
+
+static int
+cb_running_cmp (gconstpointer a, gconstpointer b)
+{
+	DependencyRange const *ra = *(DependencyRange const **)a;
+	DependencyRange const *rb = *(DependencyRange const **)b;
+	return ra->range.end.row - rb->range.end.row;
+}
+
+static GPtrArray *
+running_sorted (RunningRange *rr)
+{
+	if (rr->sorted == NULL) {
+		GHashTableIter hiter;
+		gpointer key;
+
+		rr->sorted = g_ptr_array_sized_new (g_hash_table_size (rr->ends));
+		g_hash_table_iter_init (&hiter, rr->ends);
+		while (g_hash_table_iter_next (&hiter, &key, NULL))
+			g_ptr_array_add (rr->sorted, key);
+		g_ptr_array_sort (rr->sorted, cb_running_cmp);
+	}
+	return rr->sorted;
+}
+
+static void
+running_invalidate (GnmDepContainer *deps, RunningRange *rr)
+{
+	unsigned ui;
+
+	if (rr->sorted == NULL)
+		return;
+
+	for (ui = 0; ui < rr->sorted->len; ui++) {
+		DependencyRange *dr = g_ptr_array_index (rr->sorted, ui);
+		if (micro_hash_is_empty (&dr->deps))
+			go_mem_chunk_free (deps->range_pool, dr);
+	}
+	g_ptr_array_free (rr->sorted, TRUE);
+	rr->sorted = NULL;
+	rr->dead = 0;
+}
+
+static void
+running_index_add (GnmDepContainer *deps, RunningRange *rr)
+{
+	int col;
+
+	g_ptr_array_add (deps->running, rr);
+	for (col = rr->range.start.col; col <= rr->range.end.col; col++) {
+		gpointer key = GINT_TO_POINTER (col);
+		GPtrArray *fams = g_hash_table_lookup (deps->running_cols, key);
+		if (fams == NULL) {
+			fams = g_ptr_array_new ();
+			g_hash_table_insert (deps->running_cols, key, fams);
+		}
+		g_ptr_array_add (fams, rr);
+	}
+}
+
+static void
+running_index_remove (GnmDepContainer *deps, RunningRange *rr)
+{
+	int col;
+
+	g_ptr_array_remove_fast (deps->running, rr);
+	for (col = rr->range.start.col; col <= rr->range.end.col; col++) {
+		gpointer key = GINT_TO_POINTER (col);
+		GPtrArray *fams = g_hash_table_lookup (deps->running_cols, key);
+		g_ptr_array_remove_fast (fams, rr);
+		if (fams->len == 0)
+			g_hash_table_remove (deps->running_cols, key);
+	}
+}
+
+static void
+running_free (GnmDepContainer *deps, RunningRange *rr)
+{
+	g_hash_table_remove (deps->running_hash, rr);
+	if (rr->ends) {
+		running_index_remove (deps, rr);
+		g_hash_table_destroy (rr->ends);
+	}
+	running_invalidate (deps, rr);
+	g_free (rr);
+}
+
+/* Only ranges that cross a bucket boundary are worth the trouble.  */
+static inline RunningRange *
+running_lookup (GnmDepContainer *deps, GnmRange const *r)
+{
+	RunningRange key;
+
+	if (bucket_of_row (r->start.row) == bucket_of_row (r->end.row))
+		return NULL;
+	key.range = *r;
+	return g_hash_table_lookup (deps->running_hash, &key);
+}
+
+/*
+ * Returns %TRUE if @r was linked as part of a family, %FALSE if it
+ * should go into the buckets.
+ */
+static gboolean
+running_link (GnmDepContainer *deps, GnmDependent *dep, GnmRange const *r)
+{
+	RunningRange *rr;
+	DependencyRange dr, *result;
+
+	if (bucket_of_row (r->start.row) == bucket_of_row (r->end.row))
+		return FALSE;
+
+	rr = running_lookup (deps, r);
+	if (rr == NULL) {
+		rr = g_new0 (RunningRange, 1);
+		rr->range = *r;
+		g_hash_table_insert (deps->running_hash, rr, rr);
+	}
+
+	if (rr->ends == NULL) {
+		if (rr->candidates + 1 < RUNNING_MIN_RANGES) {
+			rr->candidates++;
+			return FALSE;
+		}
+		rr->ends = g_hash_table_new ((GHashFunc) deprange_hash,
+					     (GEqualFunc) deprange_equal);
+		running_index_add (deps, rr);
+	}
+
+	dr.range = *r;
+	result = g_hash_table_lookup (rr->ends, &dr);
+	if (result) {
+		micro_hash_insert (deps, &result->deps, dep);
+		return TRUE;
+	}
+
+	result = go_mem_chunk_alloc (deps->range_pool);
+	*result = dr;
+	micro_hash_init (&result->deps, dep);
+	g_hash_table_insert (rr->ends, result, result);
+
+	/* Filling down keeps the array sorted as it grows.  */
+	if (rr->sorted && r->end.row >= rr->range.end.row)
+		g_ptr_array_add (rr->sorted, result);
+	else
+		running_invalidate (deps, rr);
+	rr->range.end.row = MAX (rr->range.end.row, r->end.row);
+
+	return TRUE;
+}
+
+/*
+ * Returns %TRUE if @dep was unlinked from a family, %FALSE if it
+ * should be looked for in the buckets.
+ */
+static gboolean
+running_unlink (GnmDepContainer *deps, GnmDependent *dep, GnmRange const *r)
+{
+	RunningRange *rr = running_lookup (deps, r);
+	gboolean found = FALSE;
+
+	if (rr == NULL)
+		return FALSE;
+
+	if (rr->ends) {
+		DependencyRange dr, *result;
+
+		dr.range = *r;
+		result = g_hash_table_lookup (rr->ends, &dr);
+		if (result) {
+			int n = result->deps.num_elements;
+			micro_hash_remove (deps, &result->deps, dep);
+			found = (n != result->deps.num_elements);
+			if (micro_hash_is_empty (&result->deps)) {
+				g_hash_table_remove (rr->ends, result);
+				micro_hash_release (deps, &result->deps);
+				if (rr->sorted == NULL)
+					go_mem_chunk_free (deps->range_pool, result);
+				else if (++rr->dead > rr->sorted->len / 2)
+					running_invalidate (deps, rr);
+			}
+		}
+	}
+
+	if (!found && rr->candidates > 0)
+		rr->candidates--;
+
+	if (rr->candidates == 0 &&
+	    (rr->ends == NULL || g_hash_table_size (rr->ends) == 0))
+		running_free (deps, rr);
+
+	return found;
+}
+
+/*
+ * Adds to @res the members of @rr that overlap @r.
+ */
+static void
+running_query_family (RunningRange *rr, GnmRange const *r, GPtrArray *res)
+{
+	GPtrArray *sorted;
+	unsigned lo, hi;
+
+	if (!range_overlap (&rr->range, r))
+		return;
+
+	/* Find the first member ending at or below r's top.  */
+	sorted = running_sorted (rr);
+	lo = 0;
+	hi = sorted->len;
+	while (lo < hi) {
+		unsigned mid = (lo + hi) / 2;
+		DependencyRange const *dr = g_ptr_array_index (sorted, mid);
+		if (dr->range.end.row < r->start.row)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (; lo < sorted->len; lo++) {
+		DependencyRange *dr = g_ptr_array_index (sorted, lo);
+		if (!micro_hash_is_empty (&dr->deps))
+			g_ptr_array_add (res, dr);
+	}
+}
+
+/*
+ * Adds to @res the family members that overlap @r.
+ */
+static void
+running_query (GnmDepContainer *deps, GnmRange const *r, GPtrArray *res)
+{
+	unsigned ui;
+	int col;
+
+	if (deps->running->len == 0)
+		return;
+
+	/* A region wider than the index is cheaper to check family by
+	 * family.  */
+	if ((guint)(r->end.col - r->start.col) >=
+	    g_hash_table_size (deps->running_cols)) {
+		for (ui = 0; ui < deps->running->len; ui++)
+			running_query_family (g_ptr_array_index (deps->running, ui),
+					      r, res);
+		return;
+	}
+
+	for (col = r->start.col; col <= r->end.col; col++) {
+		GPtrArray *fams = g_hash_table_lookup (deps->running_cols,
+						       GINT_TO_POINTER (col));
+		if (fams == NULL)
+			continue;
+		for (ui = 0; ui < fams->len; ui++) {
+			RunningRange *rr = g_ptr_array_index (fams, ui);
+			/* Only look at a family in the first column it
+			 * shares with @r.  */
+			if (col == MAX (r->start.col, rr->range.start.col))
+				running_query_family (rr, r, res);
+		}
+	}
+}
+
+/*
+ * Returns a new hash of all family members, in the form dep_hash_destroy
+ * wants.
+ */
+static GHashTable *
+running_collect (GnmDepContainer *deps)
+{
+	GHashTable *res = g_hash_table_new (g_direct_hash, g_direct_equal);
+	unsigned ui;
+
+	for (ui = 0; ui < deps->running->len; ui++) {
+		RunningRange *rr = g_ptr_array_index (deps->running, ui);
+		GHashTableIter hiter;
+		gpointer key;
+
+		g_hash_table_iter_init (&hiter, rr->ends);
+		while (g_hash_table_iter_next (&hiter, &key, NULL))
+			g_hash_table_insert (res, key, key);
+	}
+	return res;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static guint
 depsingle_hash (DependencySingle const *depsingle)
 {
@@ -895,11 +1504,110 @@ depsingle_equal (DependencySingle const *a, DependencySingle const *b)
 	return (a->pos.row == b->pos.row && a->pos.col == b->pos.col);
 }
 
-static GnmDependentFlags
-link_single_dep (GnmDependent *dep, GnmCellPos const *pos, GnmCellRef const *ref)
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Between gnm_dep_batch_link_begin and gnm_dep_batch_link_end, and at any
+ * time in lazy mode, the links made by dependent_link are only recorded
+ * in the pending_links of the container they go into.  They are entered
+ * when the batch ends or, in lazy mode, when the container is first
+ * needed, sorted so that everything referring to the same cell or range
+ * goes in at once.  Anything that looks at a container, including
+ * unlinking from it, flushes it first.
+ */
+typedef struct {
+	GnmDependent *dep;
+	GnmRange r;		/* Only r.start for single cells.  */
+	gboolean single;
+} LinkBatchItem;
+
+static int link_batch_level;
+static gboolean link_lazy;
+/* The containers with pending links.  */
+static GSList *link_batch_pending;
+
+#define link_batch_active() (link_batch_level > 0 || link_lazy)
+
+static void link_batch_flush (GnmDepContainer *deps);
+
+static void
+link_batch_add (GnmDepContainer *deps, GnmDependent *dep,
+		GnmCellPos const *pos, GnmRange const *r)
+{
+	LinkBatchItem item;
+
+	if (deps->pending_links == NULL) {
+		deps->pending_links =
+			g_array_new (FALSE, FALSE, sizeof (LinkBatchItem));
+		link_batch_pending =
+			g_slist_prepend (link_batch_pending, deps);
+	}
+
+	item.dep = dep;
+	item.single = (r == NULL);
+	if (r)
+		item.r = *r;
+	else
+		range_init_cellpos (&item.r, pos);
+	g_array_append_val (deps->pending_links, item);
+}
+
+static void
+link_batch_flush_all (void)
+{
+	while (link_batch_pending)
+		link_batch_flush (link_batch_pending->data);
+}
+
+/*
+ * For a container that is about to be destroyed.  Links from dependents
+ * that are going away with it are dropped; the others are entered so
+ * that their references can be fixed up.
+ */
+static void
+link_batch_prune (GnmDepContainer *deps)
+{
+	GArray *items = deps->pending_links;
+	guint i, n = 0;
+
+	if (items == NULL)
+		return;
+
+	for (i = 0; i < items->len; i++) {
+		LinkBatchItem const *item =
+			&g_array_index (items, LinkBatchItem, i);
+		if (!item->dep->sheet->being_invalidated)
+			g_array_index (items, LinkBatchItem, n++) = *item;
+	}
+	g_array_set_size (items, n);
+	link_batch_flush (deps);
+}
+
+static void
+link_single_deps (GnmDepContainer *deps, GnmCellPos const *pos,
+		  GnmDependent **dv, int n)
 {
 	DependencySingle lookup;
 	DependencySingle *single;
+
+	/* Inserts if it is not already there */
+	lookup.pos = *pos;
+	single = g_hash_table_lookup (deps->single_hash, &lookup);
+	if (single == NULL) {
+		single = go_mem_chunk_alloc (deps->single_pool);
+		*single = lookup;
+		micro_hash_init (&single->deps, dv[0]);
+		g_hash_table_insert (deps->single_hash, single, single);
+		dv++;
+		n--;
+	}
+	micro_hash_insert_many (deps, &single->deps, (gpointer *)dv, n);
+}
+
+static GnmDependentFlags
+link_single_dep (GnmDependent *dep, GnmCellPos const *pos, GnmCellRef const *ref)
+{
+	GnmCellPos cpos;
 	GnmDependentFlags flag = DEPENDENT_NO_FLAG;
 	Sheet const *sheet = eval_sheet (ref->sheet, dep->sheet);
 	GnmDepContainer *deps = sheet->deps;
@@ -909,16 +1617,11 @@ link_single_dep (GnmDependent *dep, GnmCellPos const *pos, GnmCellRef const *ref
 			? DEPENDENT_GOES_INTERBOOK
 			: DEPENDENT_GOES_INTERSHEET;
 
-	/* Inserts if it is not already there */
-	gnm_cellpos_init_cellref (&lookup.pos, ref, pos, sheet);
-	single = g_hash_table_lookup (deps->single_hash, &lookup);
-	if (single == NULL) {
-		single = go_mem_chunk_alloc (deps->single_pool);
-		*single = lookup;
-		micro_hash_init (&single->deps, dep);
-		g_hash_table_insert (deps->single_hash, single, single);
-	} else
-		micro_hash_insert (&single->deps, dep);
+	gnm_cellpos_init_cellref (&cpos, ref, pos, sheet);
+	if (link_batch_active ())
+		link_batch_add (deps, dep, &cpos, NULL);
+	else
+		link_single_deps (deps, &cpos, &dep, 1);
 
 	return flag;
 }
@@ -939,13 +1642,14 @@ unlink_single_dep (GnmDependent *dep, GnmCellPos const *pos, GnmCellRef const *a
 	if (!deps)
 		return flag;
 
+	link_batch_flush (deps);
 	gnm_cellpos_init_cellref (&lookup.pos, a, pos, sheet);
 	single = g_hash_table_lookup (deps->single_hash, &lookup);
 	if (single != NULL) {
-		micro_hash_remove (&single->deps, dep);
+		micro_hash_remove (deps, &single->deps, dep);
 		if (micro_hash_is_empty (&single->deps)) {
 			g_hash_table_remove (deps->single_hash, single);
-			micro_hash_release (&single->deps);
+			micro_hash_release (deps, &single->deps);
 			go_mem_chunk_free (deps->single_pool, single);
 		}
 	}
@@ -964,8 +1668,8 @@ link_unlink_single_dep (GnmDependent *dep, GnmCellPos const *pos,
 
 
 static void
-link_range_dep (GnmDepContainer *deps, GnmDependent *dep,
-		GnmRange const *r)
+link_range_deps (GnmDepContainer *deps, GnmDependent **dv, int n,
+		 GnmRange const *r)
 {
 	int i = bucket_of_row (r->start.row);
 	int end = bucket_of_row (r->end.row);
@@ -1001,7 +1705,8 @@ link_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 			result = g_hash_table_lookup (deps->range_hash[i], &dr);
 			if (result) {
 				/* Inserts if it is not already there */
-				micro_hash_insert (&result->deps, dep);
+				micro_hash_insert_many (deps, &result->deps,
+							(gpointer *)dv, n);
 				continue;
 			}
 		}
@@ -1009,11 +1714,24 @@ link_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 		/* Create a new DependencyRange structure */
 		result = go_mem_chunk_alloc (deps->range_pool);
 		*result = dr;
-		micro_hash_init (&result->deps, dep);
+		micro_hash_init (&result->deps, dv[0]);
+		micro_hash_insert_many (deps, &result->deps,
+					(gpointer *)dv + 1, n - 1);
 		g_hash_table_insert (deps->range_hash[i], result, result);
+		range_index_invalidate (deps, i);
 	}
 }
 
+static void
+link_range_dep (GnmDepContainer *deps, GnmDependent *dep,
+		GnmRange const *r)
+{
+	if (link_batch_active ())
+		link_batch_add (deps, dep, NULL, r);
+	else if (!running_link (deps, dep, r))
+		link_range_deps (deps, &dep, 1, r);
+}
+
 static void
 unlink_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 		  GnmRange const *r)
@@ -1025,6 +1743,9 @@ unlink_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 
 	if (!deps)
 		return;
+	link_batch_flush (deps);
+	if (running_unlink (deps, dep, r))
+		return;
 	dr.range = *r;
 
 	end = MIN (end, deps->buckets - 1);
@@ -1044,10 +1765,11 @@ unlink_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 
 		result = g_hash_table_lookup (deps->range_hash[i], &dr);
 		if (result) {
-			micro_hash_remove (&result->deps, dep);
+			micro_hash_remove (deps, &result->deps, dep);
 			if (micro_hash_is_empty (&result->deps)) {
 				g_hash_table_remove (deps->range_hash[i], result);
-				micro_hash_release (&result->deps);
+				range_index_invalidate (deps, i);
+				micro_hash_release (deps, &result->deps);
 				go_mem_chunk_free (deps->range_pool, result);
 			}
 		}
@@ -1064,6 +1786,67 @@ link_unlink_range_dep (GnmDepContainer *deps, GnmDependent *dep,
 		unlink_range_dep (deps, dep, r);
 }
 
+static int
+cb_link_batch_cmp (gconstpointer a_, gconstpointer b_)
+{
+	LinkBatchItem const *a = a_;
+	LinkBatchItem const *b = b_;
+
+	if (a->single != b->single)
+		return a->single ? -1 : 1;
+	if (a->r.start.row != b->r.start.row)
+		return a->r.start.row - b->r.start.row;
+	if (a->r.start.col != b->r.start.col)
+		return a->r.start.col - b->r.start.col;
+	if (a->r.end.row != b->r.end.row)
+		return a->r.end.row - b->r.end.row;
+	return a->r.end.col - b->r.end.col;
+}
+
+static void
+link_batch_flush (GnmDepContainer *deps)
+{
+	GArray *items = deps->pending_links;
+	GPtrArray *dv;
+	guint i, j;
+
+	if (items == NULL)
+		return;
+	deps->pending_links = NULL;
+	link_batch_pending = g_slist_remove (link_batch_pending, deps);
+
+	g_array_sort (items, cb_link_batch_cmp);
+
+	dv = g_ptr_array_new ();
+	for (i = 0; i < items->len; i = j) {
+		LinkBatchItem const *first =
+			&g_array_index (items, LinkBatchItem, i);
+
+		g_ptr_array_set_size (dv, 0);
+		for (j = i; j < items->len; j++) {
+			LinkBatchItem const *item =
+				&g_array_index (items, LinkBatchItem, j);
+			if (cb_link_batch_cmp (first, item) != 0)
+				break;
+			if (first->single ||
+			    !running_link (deps, item->dep, &item->r))
+				g_ptr_array_add (dv, item->dep);
+		}
+
+		if (dv->len == 0)
+			continue;
+		if (first->single)
+			link_single_deps (deps, &first->r.start,
+					  (GnmDependent **)dv->pdata, dv->len);
+		else
+			link_range_deps (deps,
+					 (GnmDependent **)dv->pdata, dv->len,
+					 &first->r);
+	}
+	g_ptr_array_free (dv, TRUE);
+	g_array_free (items, TRUE);
+}
+
 static GnmDependentFlags
 link_unlink_cellrange_dep (GnmDependent *dep, GnmCellPos const *pos,
 			   GnmCellRef const *a, GnmCellRef const *b,
@@ -1385,54 +2168,271 @@ dependent_managed_init (GnmDepManaged *dep, Sheet *sheet)
 	dep->base.sheet = sheet;
 }
 
-GnmExprTop const *
-dependent_managed_get_expr (GnmDepManaged const *dep)
+GnmExprTop const *
+dependent_managed_get_expr (GnmDepManaged const *dep)
+{
+	g_return_val_if_fail (dep != NULL, NULL);
+	return dep->base.texpr;
+}
+
+void
+dependent_managed_set_expr (GnmDepManaged *dep, GnmExprTop const *texpr)
+{
+	g_return_if_fail (dep != NULL);
+#if 0
+	/* We need some kind of IS_A */
+	g_return_if_fail (dependent_type (dep) == DEPENDENT_MANAGED);
+#endif
+
+	dependent_set_expr (&dep->base, texpr);
+	if (texpr && dep->base.sheet)
+		dependent_link (&dep->base);
+}
+
+void
+dependent_managed_set_sheet (GnmDepManaged *dep, Sheet *sheet)
+{
+	GnmExprTop const *texpr;
+
+	g_return_if_fail (dep != NULL);
+#if 0
+	/* We need some kind of IS_A */
+	g_return_if_fail (dependent_type (dep) == DEPENDENT_MANAGED);
+#endif
+
+	if (dep->base.sheet == sheet)
+		return;
+
+	texpr = dep->base.texpr;
+	gnm_expr_top_ref (texpr);
+	dependent_set_expr (&dep->base, NULL);
+	/* We're now unlinked from everything. */
+	dep->base.sheet = sheet;
+	dependent_managed_set_expr (dep, texpr);
+	gnm_expr_top_unref (texpr);
+}
+
+static void
+managed_dep_debug_name (GnmDependent const *dep, GString *target)
+{
+	g_string_append_printf (target, "Managed%p", (void *)dep);
+}
+
+/*****************************************************************************/
+/*
+ * Range watches.
+ *
+ * A range watch is a dependent on a single-sheet range whose only purpose
+ * is to notice when anything in the range changes.  Caches of data
+ * extracted from a range keep a watch on it and throw the data away once
+ * the watch has gone stale.  Watches on the same range are shared until
+ * they go stale.
+ */
+
+struct GnmRangeWatch_ {
+	GnmDependent base;
+	GnmValue *range;
+	unsigned ref_count;
+	gboolean stale;
+	gboolean sheet_gone;
+};
+
+/* Live watches, by range.  */
+static GHashTable *range_watches;
+/* Unreferenced watches waiting for the recalc to finish.  */
+static GSList *range_watches_dead;
+static unsigned range_watch_generation;
+
+static void
+range_watch_mark_stale (GnmRangeWatch *w)
+{
+	if (w->stale)
+		return;
+
+	w->stale = TRUE;
+	range_watch_generation++;
+	if (g_hash_table_lookup (range_watches, w->range) == w)
+		g_hash_table_remove (range_watches, w->range);
+}
+
+static void
+range_watch_eval (G_GNUC_UNUSED GnmDependent *dep)
+{
+	/* Nothing; we only care about being told of changes.  */
+}
+
+static void
+range_watch_changed (GnmDependent *dep, G_GNUC_UNUSED GPtrArray *extra)
+{
+	range_watch_mark_stale ((GnmRangeWatch *)dep);
+}
+
+static void
+range_watch_set_expr (GnmDependent *dep, GnmExprTop const *new_texpr)
+{
+	/* Replacing the expression means the range was relocated.  */
+	if (dep->texpr && new_texpr)
+		range_watch_mark_stale ((GnmRangeWatch *)dep);
+
+	gnm_expr_top_ref (new_texpr);
+	gnm_expr_top_unref (dep->texpr);
+	dep->texpr = new_texpr;
+}
+
+static void
+range_watch_debug_name (GnmDependent const *dep, GString *target)
+{
+	g_string_append_printf (target, "RangeWatch%p", (void *)dep);
+}
+
+static DEPENDENT_MAKE_TYPE (range_watch,
+			    .eval = range_watch_eval,
+			    .set_expr = range_watch_set_expr,
+			    .changed = range_watch_changed,
+			    .debug_name = range_watch_debug_name)
+
+static void range_watch_free (GnmRangeWatch *w);
+
+static void
+cb_range_watch_sheet_gone (gpointer data,
+			   G_GNUC_UNUSED GObject *where_the_sheet_was)
+{
+	GnmRangeWatch *w = data;
+
+	w->sheet_gone = TRUE;
+	range_watch_mark_stale (w);
+	if (dependent_is_linked (&w->base))
+		dependent_unlink (&w->base);
+
+	if (w->ref_count == 0) {
+		range_watches_dead = g_slist_remove (range_watches_dead, w);
+		range_watch_free (w);
+	}
+}
+
+static void
+range_watch_free (GnmRangeWatch *w)
+{
+	if (!w->sheet_gone)
+		g_object_weak_unref (G_OBJECT (w->base.sheet),
+				     cb_range_watch_sheet_gone, w);
+	dependent_set_expr (&w->base, NULL);
+	value_release (w->range);
+	g_free (w);
+}
+
+static void
+range_watches_free_dead (void)
+{
+	GSList *dead;
+
+	if (!range_watches_dead || gnm_app_recalc_in_progress ())
+		return;
+
+	dead = range_watches_dead;
+	range_watches_dead = NULL;
+	g_slist_free_full (dead, (GDestroyNotify)range_watch_free);
+}
+
+/**
+ * gnm_range_watch_new:
+ * @range: a cell range on a single sheet.  Relative references are not
+ * allowed.
+ *
+ * Returns: (transfer full): a watch on @range.
+ */
+GnmRangeWatch *
+gnm_range_watch_new (GnmValue const *range)
 {
-	g_return_val_if_fail (dep != NULL, NULL);
-	return dep->base.texpr;
+	GnmRangeWatch *w;
+	GnmExprTop const *texpr;
+	Sheet *sheet;
+
+	g_return_val_if_fail (VALUE_IS_CELLRANGE (range), NULL);
+	sheet = range->v_range.cell.a.sheet;
+	g_return_val_if_fail (IS_SHEET (sheet), NULL);
+
+	range_watches_free_dead ();
+
+	if (!range_watches)
+		range_watches = g_hash_table_new ((GHashFunc)value_hash,
+						  (GEqualFunc)value_equal);
+
+	w = g_hash_table_lookup (range_watches, range);
+	if (w) {
+		w->ref_count++;
+		return w;
+	}
+
+	w = g_new0 (GnmRangeWatch, 1);
+	w->base.flags = range_watch_dep_type = range_watch_get_dep_type ();
+	w->base.sheet = sheet;
+	w->range = value_dup (range);
+	w->ref_count = 1;
+
+	texpr = gnm_expr_top_new_constant (value_dup (range));
+	dependent_set_expr (&w->base, texpr);
+	gnm_expr_top_unref (texpr);
+	dependent_link (&w->base);
+
+	g_object_weak_ref (G_OBJECT (sheet), cb_range_watch_sheet_gone, w);
+	g_hash_table_insert (range_watches, w->range, w);
+
+	return w;
 }
 
-void
-dependent_managed_set_expr (GnmDepManaged *dep, GnmExprTop const *texpr)
+GnmRangeWatch *
+gnm_range_watch_ref (GnmRangeWatch *w)
 {
-	g_return_if_fail (dep != NULL);
-#if 0
-	/* We need some kind of IS_A */
-	g_return_if_fail (dependent_type (dep) == DEPENDENT_MANAGED);
-#endif
-
-	dependent_set_expr (&dep->base, texpr);
-	if (texpr && dep->base.sheet)
-		dependent_link (&dep->base);
+	g_return_val_if_fail (w != NULL, NULL);
+	w->ref_count++;
+	return w;
 }
 
 void
-dependent_managed_set_sheet (GnmDepManaged *dep, Sheet *sheet)
+gnm_range_watch_unref (GnmRangeWatch *w)
 {
-	GnmExprTop const *texpr;
+	if (w == NULL || --w->ref_count > 0)
+		return;
 
-	g_return_if_fail (dep != NULL);
-#if 0
-	/* We need some kind of IS_A */
-	g_return_if_fail (dependent_type (dep) == DEPENDENT_MANAGED);
-#endif
+	if (g_hash_table_lookup (range_watches, w->range) == w)
+		g_hash_table_remove (range_watches, w->range);
 
-	if (dep->base.sheet == sheet)
-		return;
+	/*
+	 * The recalc engine may be walking the list we are linked into,
+	 * so postpone unlinking until it is done.
+	 */
+	if (!w->sheet_gone && gnm_app_recalc_in_progress ())
+		range_watches_dead = g_slist_prepend (range_watches_dead, w);
+	else
+		range_watch_free (w);
 
-	texpr = dep->base.texpr;
-	gnm_expr_top_ref (texpr);
-	dependent_set_expr (&dep->base, NULL);
-	/* We're now unlinked from everything. */
-	dep->base.sheet = sheet;
-	dependent_managed_set_expr (dep, texpr);
-	gnm_expr_top_unref (texpr);
+	range_watches_free_dead ();
 }
 
-static void
-managed_dep_debug_name (GnmDependent const *dep, GString *target)
+/**
+ * gnm_range_watch_is_stale:
+ * @w: #GnmRangeWatch
+ *
+ * Returns: %TRUE if anything in the range has changed, if the range has
+ * been moved, or if its sheet has gone away since @w was created.
+ */
+gboolean
+gnm_range_watch_is_stale (GnmRangeWatch const *w)
 {
-	g_string_append_printf (target, "Managed%p", (void *)dep);
+	g_return_val_if_fail (w != NULL, TRUE);
+	return w->stale;
+}
+
+/**
+ * gnm_range_watch_generation:
+ *
+ * Returns: a number that changes whenever any range watch goes stale.
+ */
+unsigned
+gnm_range_watch_generation (void)
+{
+	return range_watch_generation;
 }
 
 /*****************************************************************************/
@@ -1532,14 +2532,15 @@ dependent_link (GnmDependent *dep)
 
 	sheet = dep->sheet;
 
-	/* Make this the new tail of the dependent list.  */
-	dep->prev_dep = sheet->deps->tail;
-	dep->next_dep = NULL;
-	if (dep->prev_dep)
-		dep->prev_dep->next_dep = dep;
-	else
-		sheet->deps->head = dep; /* first element */
-	sheet->deps->tail = dep;
+	/* Make this the new tail of the dependent list, or of the
+	 * recalc queue if it is dirty.  */
+	if (dependent_needs_recalc (dep)) {
+		dep_list_insert_after (sheet->deps, sheet->deps->queued_tail, dep);
+		sheet->deps->queued_tail = dep;
+		dep->flags |= DEPENDENT_QUEUED;
+		dep_queue_stamp++;
+	} else
+		dep_list_insert_after (sheet->deps, sheet->deps->tail, dep);
 
 	t = dependent_type (dep);
 	klass = g_ptr_array_index (dep_classes, t);
@@ -1576,14 +2577,7 @@ dependent_unlink (GnmDependent *dep)
 			      dep->texpr->expr, DEP_LINK_UNLINK);
 	contain = dep->sheet->deps;
 	if (contain != NULL) {
-		if (contain->head == dep)
-			contain->head = dep->next_dep;
-		if (contain->tail == dep)
-			contain->tail = dep->prev_dep;
-		if (dep->next_dep)
-			dep->next_dep->prev_dep = dep->prev_dep;
-		if (dep->prev_dep)
-			dep->prev_dep->next_dep = dep->next_dep;
+		dep_list_remove (contain, dep);
 
 		if (dep->flags & DEPENDENT_HAS_DYNAMIC_DEPS)
 			dependent_clear_dynamic_deps (dep);
@@ -1594,6 +2588,54 @@ dependent_unlink (GnmDependent *dep)
 	dep->flags &= ~DEPENDENT_LINK_FLAGS;
 }
 
+/**
+ * gnm_dep_batch_link_begin:
+ *
+ * Starts a batch of dependent_link calls, as when loading a file or
+ * pasting a large block.  Rather than being entered into the dependency
+ * containers one at a time, the links are grouped by the cell or range
+ * they refer to and entered together when the batch ends.
+ *
+ * Batches nest.  Everything behaves as usual in the meantime; lookups
+ * just flush what has been collected so far.
+ */
+void
+gnm_dep_batch_link_begin (void)
+{
+	link_batch_level++;
+}
+
+/**
+ * gnm_dep_batch_link_end:
+ *
+ * Ends a batch started by gnm_dep_batch_link_begin.
+ */
+void
+gnm_dep_batch_link_end (void)
+{
+	g_return_if_fail (link_batch_level > 0);
+
+	if (--link_batch_level == 0 && !link_lazy)
+		link_batch_flush_all ();
+}
+
+/**
+ * gnm_dep_set_lazy_link:
+ * @lazy: whether to link lazily
+ *
+ * In lazy mode, links made by dependent_link are kept pending for as
+ * long as nothing needs them, which may be never.  That suits loading a
+ * file only to save it in another format.  Turning the mode off enters
+ * all pending links.
+ */
+void
+gnm_dep_set_lazy_link (gboolean lazy)
+{
+	link_lazy = lazy;
+	if (!lazy && link_batch_level == 0)
+		link_batch_flush_all ();
+}
+
 /**
  * gnm_cell_eval_content:
  * @cell: the cell to evaluate.
@@ -1766,7 +2808,13 @@ dependent_eval (GnmDependent *dep)
 	/*
 	 * Problem: this really should be a tail call.
 	 */
-	klass->eval (dep);
+	if (G_UNLIKELY (gnm_recalc_profiling)) {
+		GnmRecalcProfileFrame frame;
+		gnm_recalc_profile_enter (&frame);
+		klass->eval (dep);
+		gnm_recalc_profile_leave_dep (&frame, dep);
+	} else
+		klass->eval (dep);
 
 	/* Don't clear flag until after in case we iterate */
 	dep->flags &= ~DEPENDENT_NEEDS_RECALC;
@@ -1786,25 +2834,28 @@ gnm_dep_cell_eval (GnmCell *cell)
 static void
 cell_foreach_range_dep (Sheet const *sheet, int col, int row, GnmDepFunc func, gpointer user)
 {
-	GHashTable *bucket =
-		sheet->deps->range_hash[bucket_of_row (row)];
-	GHashTableIter hiter;
-	gpointer key;
-
-	if (!bucket)
-		return;
-
-	g_hash_table_iter_init (&hiter, bucket);
-	while (g_hash_table_iter_next (&hiter, &key, NULL)) {
-		DependencyRange const *deprange = key;
-		GnmRange const *range = &(deprange->range);
+	/* Reused between calls, unless we are called recursively.  */
+	static GPtrArray *spare;
+	GPtrArray *hits = spare ? spare : g_ptr_array_new ();
+	GnmRange r;
+	unsigned ui;
 
-		if (!range_contains (range, col, row))
-			continue;
+	spare = NULL;
+	range_init (&r, col, row, col, row);
+	range_index_query (sheet->deps, bucket_of_row (row), &r, hits);
+	running_query (sheet->deps, &r, hits);
 
+	for (ui = 0; ui < hits->len; ui++) {
+		DependencyRange const *deprange = g_ptr_array_index (hits, ui);
 		micro_hash_foreach_dep (deprange->deps, dep,
 					func (dep, user););
 	}
+
+	g_ptr_array_set_size (hits, 0);
+	if (spare)
+		g_ptr_array_free (hits, TRUE);
+	else
+		spare = hits;
 }
 
 static void
@@ -1835,6 +2886,7 @@ cell_foreach_single_dep (Sheet const *sheet, int col, int row,
 static void
 gnm_dep_cellpos_foreach_dep (Sheet const *sheet, int col, int row, GnmDepFunc func, gpointer user)
 {
+	link_batch_flush (sheet->deps);
 	cell_foreach_range_dep (sheet, col, row, func, user);
 	cell_foreach_single_dep (sheet, col, row, func, user);
 }
@@ -1898,6 +2950,8 @@ sheet_region_queue_recalc (Sheet const *sheet, GnmRange const *r)
 	g_return_if_fail (IS_SHEET (sheet));
 	g_return_if_fail (sheet->deps != NULL);
 
+	link_batch_flush (sheet->deps);
+
 	sb = r ? bucket_of_row (r->start.row) : 0;
 	eb = r ? bucket_of_row (r->end.row) : sheet->deps->buckets - 1;
 
@@ -1914,13 +2968,44 @@ sheet_region_queue_recalc (Sheet const *sheet, GnmRange const *r)
 	// queue deps.
 	for (i = eb; i >= sb; i--) {
 		GHashTable *hash = sheet->deps->range_hash[i];
+		GPtrArray *hits;
+		unsigned ui;
+
 		if (!hash) continue;
-		keys = g_hash_table_get_keys (hash);
-		for (l = keys; l; l = l->next) {
-			DependencyRange const *dr  = l->data;
+		hits = g_ptr_array_new ();
+		if (r)
+			range_index_query (sheet->deps, i, r, hits);
+		else {
+			keys = g_hash_table_get_keys (hash);
+			for (l = keys; l; l = l->next)
+				g_ptr_array_add (hits, l->data);
+			g_list_free (keys);
+		}
+		for (ui = 0; ui < hits->len; ui++) {
+			DependencyRange const *dr = g_ptr_array_index (hits, ui);
+
+			micro_hash_foreach_dep (dr->deps, dep, {
+				if (!dependent_needs_recalc (dep)) {
+					dependent_flag_recalc (dep);
+					g_ptr_array_add (work, dep);
+				}
+			});
+			dependent_queue_recalc_main (work);
+		}
+		g_ptr_array_free (hits, TRUE);
+	}
+
+	if (sheet->deps->running->len > 0) {
+		GPtrArray *hits = g_ptr_array_new ();
+		GnmRange full;
+		unsigned ui;
+
+		running_query (sheet->deps,
+			       r ? r : range_init_full_sheet (&full, sheet),
+			       hits);
+		for (ui = 0; ui < hits->len; ui++) {
+			DependencyRange const *dr = g_ptr_array_index (hits, ui);
 
-			if (r && !range_overlap (r, &dr->range))
-				continue;
 			micro_hash_foreach_dep (dr->deps, dep, {
 				if (!dependent_needs_recalc (dep)) {
 					dependent_flag_recalc (dep);
@@ -1929,7 +3014,7 @@ sheet_region_queue_recalc (Sheet const *sheet, GnmRange const *r)
 			});
 			dependent_queue_recalc_main (work);
 		}
-		g_list_free (keys);
+		g_ptr_array_free (hits, TRUE);
 	}
 
 	keys = g_hash_table_get_keys (sheet->deps->single_hash);
@@ -2152,12 +3237,13 @@ GOUndo *
 dependents_relocate (GnmExprRelocateInfo const *rinfo)
 {
 	GnmExprRelocateInfo local_rinfo;
-	GSList    *l, *dependents = NULL, *undo_info = NULL;
+	GSList    *l, *dependents = NULL, *undo_info = NULL, *relink = NULL;
 	Sheet	  *sheet;
 	GnmRange const   *r;
 	int i;
 	CollectClosure collect;
 	GOUndo *u_exprs, *u_names;
+	GnmExprSharer *es;
 
 	g_return_val_if_fail (rinfo != NULL, NULL);
 
@@ -2169,6 +3255,8 @@ dependents_relocate (GnmExprRelocateInfo const *rinfo)
 	sheet = rinfo->origin_sheet;
 	r     = &rinfo->origin;
 
+	link_batch_flush (sheet->deps);
+
 	/* collect contained cells with expressions */
 	SHEET_FOREACH_DEPENDENT (rinfo->origin_sheet, dep, {
 		GnmCell *cell = GNM_DEP_TO_CELL (dep);
@@ -2187,17 +3275,22 @@ dependents_relocate (GnmExprRelocateInfo const *rinfo)
 		(gpointer)&collect);
 	{
 		int const first = bucket_of_row (r->start.row);
-		GHashTable *hash;
-		for (i = bucket_of_row (r->end.row); i >= first ; i--) {
-			hash = sheet->deps->range_hash[i];
-			if (hash != NULL)
-				g_hash_table_foreach (hash,
-					(GHFunc) &cb_range_contained_collect,
-					(gpointer)&collect);
-		}
+		int const last = MIN (bucket_of_row (r->end.row),
+				      sheet->deps->buckets - 1);
+		GPtrArray *hits = g_ptr_array_new ();
+		unsigned ui;
+
+		for (i = last; i >= first ; i--)
+			range_index_query (sheet->deps, i, r, hits);
+		running_query (sheet->deps, r, hits);
+		for (ui = 0; ui < hits->len; ui++)
+			cb_range_contained_collect (g_ptr_array_index (hits, ui),
+						    NULL, &collect);
+		g_ptr_array_free (hits, TRUE);
 	}
 	dependents = collect.list;
 	local_rinfo = *rinfo;
+	es = gnm_expr_sharer_new ();
 	for (l = dependents; l; l = l->next) {
 		GnmExprTop const *newtree;
 		GnmDependent *dep = l->data;
@@ -2219,9 +3312,14 @@ dependents_relocate (GnmExprRelocateInfo const *rinfo)
 			if (t == DEPENDENT_NAME) {
 #warning "What should we do here and why do we leak tmp?"
 			} else {
-				if (t == DEPENDENT_CELL)
+				if (t == DEPENDENT_CELL) {
 					tmp->u.pos = local_rinfo.pos;
-				else
+					/*
+					 * A column of similar formulas usually
+					 * relocates to identical trees.
+					 */
+					newtree = gnm_expr_sharer_share (es, newtree);
+				} else
 					tmp->u.dep = dep;
 				tmp->oldtree = dep->texpr;
 				gnm_expr_top_ref (tmp->oldtree);
@@ -2243,9 +3341,9 @@ dependents_relocate (GnmExprRelocateInfo const *rinfo)
 					GnmCellPos const *pos = &GNM_DEP_TO_CELL (dep)->pos;
 					if (dep->sheet != sheet ||
 					    !range_contains (r, pos->col, pos->row))
-						dependent_link (dep);
+						relink = g_slist_prepend (relink, dep);
 				} else
-					dependent_link (dep);
+					relink = g_slist_prepend (relink, dep);
 			}
 		} else {
 			/*
@@ -2262,6 +3360,22 @@ dependents_relocate (GnmExprRelocateInfo const *rinfo)
 	}
 	g_slist_free (dependents);
 
+	/*
+	 * Relink in one go.  Nothing above missed these while they were
+	 * unlinked: they have all been queued for recalc already.
+	 */
+	gnm_dep_batch_link_begin ();
+	for (l = relink; l; l = l->next)
+		dependent_link (l->data);
+	gnm_dep_batch_link_end ();
+	g_slist_free (relink);
+
+	if (gnm_debug_flag ("expr-sharer")) {
+		g_printerr ("Relocation:\n");
+		gnm_expr_sharer_report (es);
+	}
+	gnm_expr_sharer_unref (es);
+
 	u_exprs = go_undo_unary_new (undo_info,
 				     (GOUndoUnaryFunc)dependents_unrelocate,
 				     (GFreeFunc)dependents_unrelocate_free);
@@ -2349,7 +3463,7 @@ dep_hash_destroy (GHashTable *hash, GPtrArray *dyn_deps, Sheet *sheet)
 		});
 
 		if (destroy)
-			micro_hash_release (&depany->deps);
+			micro_hash_drop (&depany->deps);
 	}
 	g_slist_free (deps);
 
@@ -2532,6 +3646,8 @@ do_deps_destroy (Sheet *sheet)
 {
 	GnmDepContainer *deps;
 	GPtrArray *dyn_deps;
+	GHashTableIter hiter;
+	gpointer key;
 	int i;
 
 	g_return_if_fail (IS_SHEET (sheet));
@@ -2554,6 +3670,8 @@ do_deps_destroy (Sheet *sheet)
 	if (deps == NULL)
 		return;
 
+	link_batch_prune (deps);
+
 	/* Destroy the records of what depends on this sheet.  There is no need
 	 * to delicately remove individual items from the lists.  The only
 	 * purpose that serves is to validate the state of our data structures.
@@ -2571,10 +3689,26 @@ do_deps_destroy (Sheet *sheet)
 		if (hash != NULL)
 			dep_hash_destroy (hash, dyn_deps, sheet);
 	}
+	dep_hash_destroy (running_collect (deps), dyn_deps, sheet);
 	dep_hash_destroy (deps->single_hash, dyn_deps, sheet);
 
 	g_free (deps->range_hash);
 	deps->range_hash = NULL;
+	for (i = deps->buckets - 1; i >= 0 ; i--)
+		range_index_free (deps, i);
+	g_free (deps->range_index);
+	deps->range_index = NULL;
+	while (deps->running->len > 0)
+		running_free (deps, g_ptr_array_index (deps->running, 0));
+	g_hash_table_iter_init (&hiter, deps->running_hash);
+	while (g_hash_table_iter_next (&hiter, &key, NULL))
+		g_free (key);
+	g_hash_table_destroy (deps->running_hash);
+	deps->running_hash = NULL;
+	g_ptr_array_free (deps->running, TRUE);
+	deps->running = NULL;
+	g_hash_table_destroy (deps->running_cols);
+	deps->running_cols = NULL;
 	/*
 	 * Note: we have not freed the elements in the pool.  This call
 	 * frees everything in one go.
@@ -2590,6 +3724,16 @@ do_deps_destroy (Sheet *sheet)
 	go_mem_chunk_destroy (deps->single_pool, TRUE);
 	deps->single_pool = NULL;
 
+	/* Likewise for the dependent sets.  */
+	if (gnm_debug_flag ("dep-pools"))
+		g_printerr ("Releasing %d small sets and %d set segments for %s\n",
+			    deps->few_count, deps->cset_count,
+			    sheet->name_unquoted);
+	go_mem_chunk_destroy (deps->few_pool, TRUE);
+	deps->few_pool = NULL;
+	go_mem_chunk_destroy (deps->cset_pool, TRUE);
+	deps->cset_pool = NULL;
+
 	/* Now that we have tossed all deps to this sheet we can queue the
 	 * external dyn deps for recalc and free them */
 	handle_dynamic_deps (dyn_deps);
@@ -2618,6 +3762,7 @@ do_deps_invalidate (Sheet *sheet)
 {
 	GnmDepContainer *deps;
 	GPtrArray *dyn_deps;
+	GHashTable *members;
 	int i;
 
 	g_return_if_fail (IS_SHEET (sheet));
@@ -2629,6 +3774,7 @@ do_deps_invalidate (Sheet *sheet)
 	gnm_named_expr_collection_unlink (sheet->names);
 
 	deps = sheet->deps;
+	link_batch_flush (deps);
 	dyn_deps = g_ptr_array_new ();
 
 	for (i = deps->buckets - 1; i >= 0 ; i--) {
@@ -2636,6 +3782,9 @@ do_deps_invalidate (Sheet *sheet)
 		if (hash != NULL)
 			dep_hash_destroy (hash, dyn_deps, sheet);
 	}
+	members = running_collect (deps);
+	dep_hash_destroy (members, dyn_deps, sheet);
+	g_hash_table_destroy (members);
 	dep_hash_destroy (deps->single_hash, dyn_deps, sheet);
 
 	/* Now that we have tossed all deps to this sheet we can queue the
@@ -2795,16 +3944,60 @@ workbook_queue_all_recalc (Workbook *wb)
 	WORKBOOK_FOREACH_DEPENDENT (wb, dep, dependent_flag_recalc (dep););
 }
 
+static void
+cb_volatile_range_watch (GnmDependent *dep, G_GNUC_UNUSED gpointer user)
+{
+	if (dependent_type (dep) == range_watch_dep_type)
+		range_watch_mark_stale ((GnmRangeWatch *)dep);
+}
+
 void
 workbook_queue_volatile_recalc (Workbook *wb)
 {
+	gboolean watched = range_watches && g_hash_table_size (range_watches);
+
 	WORKBOOK_FOREACH_DEPENDENT (wb, dep, {
-		if (dependent_is_volatile (dep))
+		if (dependent_is_volatile (dep)) {
 			dependent_flag_recalc (dep);
+			/* The watches on a volatile cell are not flagged,
+			 * so tell them here.  */
+			if (watched && dependent_is_cell (dep))
+				gnm_dep_cellpos_foreach_dep
+					(dep->sheet,
+					 GNM_DEP_TO_CELL (dep)->pos.col,
+					 GNM_DEP_TO_CELL (dep)->pos.row,
+					 cb_volatile_range_watch, NULL);
+		}
 	});
 }
 
 
+/*
+ * Walk the queued dependents of a workbook.  As for
+ * WORKBOOK_FOREACH_DEPENDENT it is only valid to muck with the current
+ * dependent in the code.  Dependents queued behind the current one while
+ * walking are visited too, but not those queued on a sheet that has
+ * already been walked, nor those queued after the current dependent was
+ * unlinked or moved; callers compare dep_queue_stamp to catch those.
+ */
+#define WORKBOOK_FOREACH_QUEUED_DEPENDENT(wb, dep, code)		\
+  do {									\
+	WORKBOOK_FOREACH_SHEET (wb, _wfq_sheet, {			\
+		GnmDependent *dep = _wfq_sheet->deps			\
+			? _wfq_sheet->deps->head			\
+			: NULL;						\
+		while (dep && (dep->flags & DEPENDENT_QUEUED)) {	\
+			GnmDependent *_next = dep->next_dep;		\
+			unsigned _stamp = dep_queue_stamp;		\
+			code;						\
+			if (_stamp != dep_queue_stamp &&		\
+			    (dep->flags & DEPENDENT_QUEUED))		\
+				_next = dep->next_dep;			\
+			dep = _next;					\
+		}							\
+	});								\
+  } while (0)
+
 /**
  * workbook_recalc:
  * @wb:
@@ -2818,25 +4011,44 @@ void
 workbook_recalc (Workbook *wb)
 {
 	gboolean redraw = FALSE;
+	unsigned stamp;
 
 	g_return_if_fail (GNM_IS_WORKBOOK (wb));
 
 	gnm_app_recalc_start ();
 
-	// Do a pass computing only cells; this allows style deps to see
-	// updated values as needed.
-	WORKBOOK_FOREACH_DEPENDENT (wb, dep, {
-		if (dependent_is_cell (dep) && dependent_needs_recalc (dep)) {
-			redraw = TRUE;
-			dependent_eval (dep);
-		}
-	});
+	// Only the queued dependents can need work.  Walk them again for
+	// as long as evaluation queues more that the walk may have missed.
+	do {
+		gboolean others = FALSE;
+
+		stamp = dep_queue_stamp;
+
+		// Do a pass computing only cells; this allows style deps
+		// to see updated values as needed.  Note whether anything
+		// else needs work so the common cells-only case gets away
+		// with one pass.
+		WORKBOOK_FOREACH_QUEUED_DEPENDENT (wb, dep, {
+			if (dependent_needs_recalc (dep)) {
+				redraw = TRUE;
+				if (dependent_is_cell (dep))
+					dependent_eval (dep);
+				else
+					others = TRUE;
+			}
+		});
 
-	WORKBOOK_FOREACH_DEPENDENT (wb, dep, {
-		if (dependent_needs_recalc (dep)) {
-			redraw = TRUE;
-			dependent_eval (dep);
+		if (others) {
+			WORKBOOK_FOREACH_QUEUED_DEPENDENT (wb, dep, {
+				if (dependent_needs_recalc (dep))
+					dependent_eval (dep);
+			});
 		}
+	} while (stamp != dep_queue_stamp);
+
+	WORKBOOK_FOREACH_SHEET (wb, sheet, {
+		if (sheet->deps)
+			dep_list_requeue (sheet->deps);
 	});
 
 	gnm_app_recalc_finish ();
@@ -2940,9 +4152,18 @@ gnm_dep_container_new (Sheet *sheet)
 	}
 
 	deps->head = deps->tail = NULL;
+	deps->queued_tail = NULL;
 
 	deps->buckets = 1 + bucket_of_row (gnm_sheet_get_last_row (sheet));
 	deps->range_hash  = g_new0 (GHashTable *, deps->buckets);
+	deps->range_index = g_new0 (gpointer, deps->buckets);
+	deps->running_hash = g_hash_table_new ((GHashFunc) running_hash,
+					       (GEqualFunc) running_equal);
+	deps->running = g_ptr_array_new ();
+	deps->running_cols = g_hash_table_new_full
+		(g_direct_hash, g_direct_equal,
+		 NULL, (GDestroyNotify)g_ptr_array_unref);
+	deps->pending_links = NULL;
 	deps->range_pool  = go_mem_chunk_new ("range pool",
 					       sizeof (DependencyRange),
 					       16 * 1024 - 100);
@@ -2951,6 +4172,14 @@ gnm_dep_container_new (Sheet *sheet)
 	deps->single_pool = go_mem_chunk_new ("single pool",
 					       sizeof (DependencySingle),
 					       16 * 1024 - 100);
+	deps->few_pool = go_mem_chunk_new ("micro few pool",
+					    MICRO_HASH_FEW * sizeof (gpointer),
+					    16 * 1024 - 128);
+	deps->few_count = 0;
+	deps->cset_pool = go_mem_chunk_new ("cset pool",
+					     sizeof (CSet),
+					     16 * 1024 - 128);
+	deps->cset_count = 0;
 	deps->referencing_names = g_hash_table_new (g_direct_hash,
 						    g_direct_equal);
 
@@ -2965,6 +4194,8 @@ gnm_dep_container_resize (GnmDepContainer *deps, int rows)
 {
 	int i, buckets = 1 + bucket_of_row (rows - 1);
 
+	link_batch_flush (deps);
+
 	for (i = buckets; i < deps->buckets; i++) {
 		GHashTable *hash = deps->range_hash[i];
 		if (hash != NULL) {
@@ -2974,12 +4205,16 @@ gnm_dep_container_resize (GnmDepContainer *deps, int rows)
 			g_hash_table_destroy (hash);
 			deps->range_hash[i] = NULL;
 		}
+		range_index_free (deps, i);
 	}
 
 	deps->range_hash = g_renew (GHashTable *, deps->range_hash, buckets);
+	deps->range_index = g_renew (gpointer, deps->range_index, buckets);
 
-	for (i = deps->buckets; i < buckets; i++)
+	for (i = deps->buckets; i < buckets; i++) {
 		deps->range_hash[i] = NULL;
+		deps->range_index[i] = NULL;
+	}
 
 	deps->buckets = buckets;
 }
@@ -3152,6 +4387,7 @@ gnm_dep_container_dump (GnmDepContainer const *deps,
 
 	g_return_if_fail (deps != NULL);
 
+	link_batch_flush ((GnmDepContainer *)deps);
 	gnm_dep_container_sanity_check (deps);
 
 	alldeps = g_hash_table_new (g_direct_hash, g_direct_equal);
@@ -3179,6 +4415,20 @@ gnm_dep_container_dump (GnmDepContainer const *deps,
 		}
 	}
 
+	for (i = 0; i < (int)deps->running->len; i++) {
+		RunningRange const *rr = g_ptr_array_index (deps->running, i);
+		GHashTableIter hiter;
+		gpointer key;
+
+		g_printerr ("  Running range %s: %d ranges with this anchor, %d in buckets\n",
+			    range_as_string (&rr->range),
+			    g_hash_table_size (rr->ends),
+			    rr->candidates);
+		g_hash_table_iter_init (&hiter, rr->ends);
+		while (g_hash_table_iter_next (&hiter, &key, NULL))
+			dump_range_dep (key, sheet, alldeps);
+	}
+
 	if (deps->single_hash && g_hash_table_size (deps->single_hash) > 0) {
 		GHashTableIter hiter;
 		gpointer key;
@@ -3241,6 +4491,9 @@ gnm_dep_container_dump (GnmDepContainer const *deps,
 		}
 	}
 
+	g_printerr ("  Dependent sets: %d small, %d segments of %d\n",
+		    deps->few_count, deps->cset_count, CSET_SEGMENT_SIZE);
+
 	g_hash_table_destroy (alldeps);
 }
 
@@ -3263,6 +4516,8 @@ gnm_dep_container_sanity_check (GnmDepContainer const *deps)
 {
 	GnmDependent const *dep;
 	GHashTable *seenb4;
+	gboolean queued;
+	int i;
 
 	if (deps->head && !deps->tail)
 		g_warning ("Dependency container %p has head, but no tail.", (void *)deps);
@@ -3273,8 +4528,58 @@ gnm_dep_container_sanity_check (GnmDepContainer const *deps)
 	if (deps->tail && deps->tail->next_dep)
 		g_warning ("Dependency container %p has tail, but not at the end.", (void *)deps);
 
+	for (i = 0; i < deps->buckets; i++) {
+		RangeIndex const *idx = deps->range_index[i];
+		GHashTable *hash = deps->range_hash[i];
+		int j;
+
+		if (idx == NULL || idx->items == NULL)
+			continue;
+		if (hash == NULL || idx->n != (int)g_hash_table_size (hash)) {
+			g_warning ("Dependency container %p has a stale range index for bucket %d.", (void *)deps, i);
+			continue;
+		}
+		for (j = 0; j < idx->n; j++) {
+			if (!g_hash_table_contains (hash, idx->items[j]))
+				g_warning ("Dependency container %p has a stale range index entry in bucket %d.", (void *)deps, i);
+			if (j > 0 && idx->items[j - 1]->range.start.col > idx->items[j]->range.start.col)
+				g_warning ("Dependency container %p has an unsorted range index for bucket %d.", (void *)deps, i);
+		}
+	}
+
+	for (i = 0; i < (int)deps->running->len; i++) {
+		RunningRange const *rr = g_ptr_array_index (deps->running, i);
+		GHashTableIter hiter;
+		gpointer key;
+		GPtrArray *fams;
+
+		if (rr->sorted &&
+		    rr->sorted->len != g_hash_table_size (rr->ends) + rr->dead)
+			g_warning ("Dependency container %p has a stale running range %s.", (void *)deps, range_as_string (&rr->range));
+		fams = g_hash_table_lookup (deps->running_cols,
+					    GINT_TO_POINTER (rr->range.start.col));
+		if (fams == NULL || !g_ptr_array_find (fams, rr, NULL))
+			g_warning ("Dependency container %p has an unindexed running range %s.", (void *)deps, range_as_string (&rr->range));
+		g_hash_table_iter_init (&hiter, rr->ends);
+		while (g_hash_table_iter_next (&hiter, &key, NULL)) {
+			DependencyRange const *dr = key;
+			if (dr->range.start.row != rr->range.start.row ||
+			    dr->range.start.col != rr->range.start.col ||
+			    dr->range.end.col != rr->range.end.col ||
+			    dr->range.end.row > rr->range.end.row)
+				g_warning ("Dependency container %p has a misplaced range %s.", (void *)deps, range_as_string (&dr->range));
+		}
+	}
+
 	seenb4 = g_hash_table_new (g_direct_hash, g_direct_equal);
+	queued = deps->queued_tail != NULL;
 	for (dep = deps->head; dep; dep = dep->next_dep) {
+		if (queued != ((dep->flags & DEPENDENT_QUEUED) != 0))
+			g_warning ("Dependency container %p has a broken recalc queue at %p.", (void *)deps, (void *)dep);
+		if (dep == deps->queued_tail)
+			queued = FALSE;
+		if (dependent_needs_recalc (dep) && !(dep->flags & DEPENDENT_QUEUED))
+			g_warning ("Dependency container %p has unqueued dirty dependency %p.", (void *)deps, (void *)dep);
 		if (dep->prev_dep && (dep->prev_dep->next_dep != dep))
 			g_warning ("Dependency container %p has left double-link failure at %p.", (void *)deps, (void *)dep);
 		if (dep->next_dep && (dep->next_dep->prev_dep != dep))
@@ -3293,3 +4598,218 @@ gnm_dep_container_sanity_check (GnmDepContainer const *deps)
 }
 
 /* ------------------------------------------------------------------------- */
+
+/*
+ * Recalc profiling.  While on, every dependent evaluation and every
+ * function call made by the expression evaluator is timed.  Times are
+ * "self" times: the time spent evaluating a cell does not include the
+ * time spent evaluating the cells it pulled in, nor the functions it
+ * called, so the numbers add up to the total.
+ *
+ * Dependents are identified by address, so the numbers only make sense
+ * while the profiled dependents stay alive.
+ */
+
+typedef struct {
+	char *name;
+	guint64 count;
+	gint64 usecs;
+} GnmRecalcProfileEntry;
+
+gboolean gnm_recalc_profiling = FALSE;
+
+static GHashTable *profile_deps;
+static GHashTable *profile_funcs;
+static GHashTable *profile_sheets;
+static GnmRecalcProfileFrame *profile_current;
+
+static void
+profile_entry_free (GnmRecalcProfileEntry *e)
+{
+	g_free (e->name);
+	g_free (e);
+}
+
+static void
+profile_clear (void)
+{
+	g_clear_pointer (&profile_deps, g_hash_table_destroy);
+	g_clear_pointer (&profile_funcs, g_hash_table_destroy);
+	g_clear_pointer (&profile_sheets, g_hash_table_destroy);
+}
+
+/**
+ * gnm_recalc_profile_start:
+ *
+ * Discards any previous profile and starts recording evaluation counts
+ * and times.
+ */
+void
+gnm_recalc_profile_start (void)
+{
+	profile_clear ();
+	profile_deps = g_hash_table_new_full
+		(g_direct_hash, g_direct_equal,
+		 NULL, (GDestroyNotify)profile_entry_free);
+	profile_funcs = g_hash_table_new_full
+		(g_direct_hash, g_direct_equal,
+		 NULL, (GDestroyNotify)profile_entry_free);
+	profile_sheets = g_hash_table_new_full
+		(g_direct_hash, g_direct_equal,
+		 NULL, (GDestroyNotify)profile_entry_free);
+	profile_current = NULL;
+	gnm_recalc_profiling = TRUE;
+}
+
+/**
+ * gnm_recalc_profile_stop:
+ *
+ * Stops recording.  The profile is kept until the next
+ * gnm_recalc_profile_start.
+ */
+void
+gnm_recalc_profile_stop (void)
+{
+	gnm_recalc_profiling = FALSE;
+}
+
+void
+gnm_recalc_profile_enter (GnmRecalcProfileFrame *frame)
+{
+	frame->start = g_get_monotonic_time ();
+	frame->children = 0;
+	frame->parent = profile_current;
+	profile_current = frame;
+}
+
+static gint64
+profile_leave (GnmRecalcProfileFrame *frame)
+{
+	gint64 elapsed = g_get_monotonic_time () - frame->start;
+
+	profile_current = frame->parent;
+	if (profile_current)
+		profile_current->children += elapsed;
+	return elapsed - frame->children;
+}
+
+static void
+profile_add (GHashTable *h, gconstpointer key, char const *name,
+	     gint64 usecs)
+{
+	GnmRecalcProfileEntry *e;
+
+	/* Profiling may have been switched on mid-flight.  */
+	if (h == NULL)
+		return;
+
+	e = g_hash_table_lookup (h, key);
+	if (e == NULL) {
+		e = g_new0 (GnmRecalcProfileEntry, 1);
+		e->name = g_strdup (name);
+		g_hash_table_insert (h, (gpointer)key, e);
+	}
+	e->count++;
+	e->usecs += usecs;
+}
+
+void
+gnm_recalc_profile_leave_dep (GnmRecalcProfileFrame *frame,
+			      GnmDependent *dep)
+{
+	gint64 usecs = profile_leave (frame);
+
+	if (profile_deps == NULL)
+		return;
+
+	/* Only name a dependent the first time we see it.  */
+	profile_add (profile_deps, dep,
+		     g_hash_table_contains (profile_deps, dep)
+		     ? NULL
+		     : dep_name (dep),
+		     usecs);
+	if (dep->sheet)
+		profile_add (profile_sheets, dep->sheet,
+			     dep->sheet->name_unquoted, usecs);
+}
+
+void
+gnm_recalc_profile_leave_func (GnmRecalcProfileFrame *frame,
+			       GnmFunc const *func, Sheet *sheet)
+{
+	gint64 usecs = profile_leave (frame);
+
+	profile_add (profile_funcs, func, gnm_func_get_name (func, FALSE),
+		     usecs);
+	if (sheet)
+		profile_add (profile_sheets, sheet,
+			     sheet->name_unquoted, usecs);
+}
+
+static gint
+cb_profile_cmp (GnmRecalcProfileEntry const **a,
+		GnmRecalcProfileEntry const **b)
+{
+	gint64 ta = (*a)->usecs, tb = (*b)->usecs;
+	return ta > tb ? -1 : (ta < tb ? +1 : g_strcmp0 ((*a)->name, (*b)->name));
+}
+
+static void
+profile_dump (GString *out, char const *kind, GHashTable *h)
+{
+	GPtrArray *entries = g_ptr_array_new ();
+	GHashTableIter hiter;
+	gpointer value;
+	unsigned ui;
+
+	if (h == NULL)
+		return;
+
+	g_hash_table_iter_init (&hiter, h);
+	while (g_hash_table_iter_next (&hiter, NULL, &value))
+		g_ptr_array_add (entries, value);
+	g_ptr_array_sort (entries, (GCompareFunc)cb_profile_cmp);
+
+	for (ui = 0; ui < entries->len; ui++) {
+		GnmRecalcProfileEntry const *e = g_ptr_array_index (entries, ui);
+		char const *p;
+
+		g_string_append (out, kind);
+		g_string_append (out, ",\"");
+		for (p = e->name ? e->name : ""; *p; p++) {
+			if (*p == '"')
+				g_string_append_c (out, '"');
+			g_string_append_c (out, *p);
+		}
+		g_string_append_printf (out, "\",%" G_GUINT64_FORMAT ",%.6f\n",
+					e->count, e->usecs / 1e6);
+	}
+
+	g_ptr_array_free (entries, TRUE);
+}
+
+/**
+ * gnm_recalc_profile_save:
+ * @filename: file to write
+ * @err: #GError
+ *
+ * Writes the current profile as CSV with columns kind, name, count and
+ * seconds.  Kind is one of "sheet", "function" and "dependent"; each
+ * kind is sorted by decreasing time.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+gnm_recalc_profile_save (char const *filename, GError **err)
+{
+	GString *out = g_string_new ("kind,name,count,seconds\n");
+	gboolean res;
+
+	profile_dump (out, "sheet", profile_sheets);
+	profile_dump (out, "function", profile_funcs);
+	profile_dump (out, "dependent", profile_deps);
+
+	res = g_file_set_contents (filename, out->str, out->len, err);
+	g_string_free (out, TRUE);
+	return res;
+}
@@ -2,6 +2,7 @@
 #define GNM_DEPENDENT_H_
 
 #include <gnumeric.h>
+#include <libgnumeric.h>
 #include <goffice/goffice.h>
 
 G_BEGIN_DECLS
@@ -57,6 +58,8 @@ typedef enum {
 	DEPENDENT_GOES_INTERBOOK   = 0x00020000,
 	DEPENDENT_USES_NAME	   = 0x00040000,
 	DEPENDENT_HAS_3D	   = 0x00080000,
+	/* In the recalc queue at the front of the container's list */
+	DEPENDENT_QUEUED	   = 0x00100000,
 	DEPENDENT_HAS_DYNAMIC_DEPS = 0x00200000,
 	DEPENDENT_IGNORE_ARGS	   = 0x00400000,
 	DEPENDENT_LINK_FLAGS	   = 0x007ff000,
@@ -74,6 +77,11 @@ typedef enum {
 struct GnmDepContainer_ {
 	GnmDependent *head, *tail;
 
+	/* Dependents needing recalc are kept first in the list, in the
+	 * order they were queued.  This is the last of them, if any.
+	 */
+	GnmDependent *queued_tail;
+
 	/* Large ranges hashed on 'range' to accelerate duplicate culling. This
 	 * is traversed by g_hash_table_foreach mostly.
 	 */
@@ -81,12 +89,36 @@ struct GnmDepContainer_ {
 	GHashTable **range_hash;
 	GOMemChunk *range_pool;
 
+	/* Per bucket, an index over the keys of range_hash for finding
+	 * the ranges that touch a cell or region.  Private.
+	 */
+	gpointer *range_index;
+
+	/* Families of large ranges that share their top-left corner and
+	 * columns, such as a filled-down =SUM($A$1:A1), stored once
+	 * instead of in every bucket they cross.  Private.
+	 */
+	GHashTable *running_hash;
+	GPtrArray *running;
+	GHashTable *running_cols;	/* Column -> families covering it.  */
+
+	/* Links not yet entered above; see gnm_dep_batch_link_begin.
+	 * Private.
+	 */
+	GArray *pending_links;
+
 	/* Single ranges, this maps an GnmEvalPos * to a GSList of its
 	 * dependencies.
 	 */
 	GHashTable *single_hash;
 	GOMemChunk *single_pool;
 
+	/* Storage for the dependent sets of the above.  Like the pools
+	 * above, these are released in one go with the container.
+	 */
+	GOMemChunk *few_pool, *cset_pool;
+	int few_count, cset_count;
+
 	/* All of the ExprNames that refer to this container */
 	GHashTable *referencing_names;
 
@@ -116,6 +148,9 @@ void dependent_move (GnmDependent *dep, int dx, int dy);
 
 GOUndo  *dependents_relocate	    (GnmExprRelocateInfo const *info);
 void	 dependents_link	    (GSList *deps);
+void	 gnm_dep_batch_link_begin   (void);
+void	 gnm_dep_batch_link_end     (void);
+void	 gnm_dep_set_lazy_link      (gboolean lazy);
 
 void	 gnm_dep_cell_eval	    (GnmCell *cell);
 void     gnm_dep_deps_of_cellpos    (Sheet const *sheet, int col, int row, GPtrArray *deps);
@@ -148,6 +183,33 @@ void dependent_managed_set_sheet (GnmDepManaged *dep, Sheet *sheet);
 
 // ----------------------------------------------------------------------------
 
+GnmRangeWatch *gnm_range_watch_new (GnmValue const *range);
+GnmRangeWatch *gnm_range_watch_ref (GnmRangeWatch *w);
+void gnm_range_watch_unref (GnmRangeWatch *w);
+gboolean gnm_range_watch_is_stale (GnmRangeWatch const *w);
+unsigned gnm_range_watch_generation (void);
+
+// ----------------------------------------------------------------------------
+
+typedef struct GnmRecalcProfileFrame_ GnmRecalcProfileFrame;
+struct GnmRecalcProfileFrame_ {
+	gint64 start, children;
+	GnmRecalcProfileFrame *parent;
+};
+
+GNM_VAR_DECL gboolean gnm_recalc_profiling;
+
+void gnm_recalc_profile_start (void);
+void gnm_recalc_profile_stop (void);
+gboolean gnm_recalc_profile_save (char const *filename, GError **err);
+void gnm_recalc_profile_enter (GnmRecalcProfileFrame *frame);
+void gnm_recalc_profile_leave_dep (GnmRecalcProfileFrame *frame,
+				   GnmDependent *dep);
+void gnm_recalc_profile_leave_func (GnmRecalcProfileFrame *frame,
+				    GnmFunc const *func, Sheet *sheet);
+
+// ----------------------------------------------------------------------------
+
 #define DEPENDENT_CONTAINER_FOREACH_DEPENDENT(dc, dep, code)	\
   do {								\
 	GnmDependent *dep = (dc)->head;				\
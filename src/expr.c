@@ -913,6 +913,103 @@ value_intersection (GnmValue *v, GnmEvalPos const *pos)
 	return value_new_error_VALUE (pos);
 }
 
+/*
+ * Plain floating-point version of bin_arith.  Returns FALSE, instead of
+ * an error value, when the operation is not defined or overflows.
+ */
+static gboolean
+arith_float (GnmExprOp op, gnm_float a, gnm_float b, gnm_float *res)
+{
+	switch (op) {
+	case GNM_EXPR_OP_ADD: *res = a + b; break;
+	case GNM_EXPR_OP_SUB: *res = a - b; break;
+	case GNM_EXPR_OP_MULT: *res = a * b; break;
+	case GNM_EXPR_OP_DIV:
+		if (b == 0)
+			return FALSE;
+		*res = a / b;
+		break;
+	case GNM_EXPR_OP_EXP:
+		if ((a == 0 && b <= 0) || (a < 0 && b != (int)b))
+			return FALSE;
+		*res = gnm_pow (a, b);
+		break;
+	default:
+		g_assert_not_reached ();
+	}
+	return gnm_finite (*res);
+}
+
+/*
+ * Evaluate an arithmetic operand as an unboxed number, without
+ * allocating any values.  This covers numeric constants, references
+ * to numeric or empty cells and arithmetic over those.  FALSE means the
+ * caller must use gnm_expr_eval, which has no side effects to repeat
+ * since only cells were evaluated.
+ */
+static gboolean
+gnm_expr_eval_float (GnmExpr const *expr, GnmEvalPos const *pos,
+		     gnm_float *res, int depth)
+{
+	gnm_float a, b;
+
+	switch (GNM_EXPR_GET_OPER (expr)) {
+	case GNM_EXPR_OP_CONSTANT: {
+		GnmValue const *v = expr->constant.value;
+		if (!VALUE_IS_NUMBER (v))
+			return FALSE;
+		*res = value_get_as_float (v);
+		return TRUE;
+	}
+
+	case GNM_EXPR_OP_CELLREF: {
+		GnmCellRef r;
+		GnmCell *cell;
+
+		gnm_cellref_make_abs (&r, &expr->cellref.ref, pos);
+		cell = sheet_cell_get (eval_sheet (r.sheet, pos->sheet),
+				       r.col, r.row);
+		if (cell == NULL) {
+			*res = 0;
+			return TRUE;
+		}
+		gnm_dep_cell_eval (cell);
+		if (VALUE_IS_EMPTY (cell->value))
+			*res = 0;
+		else if (VALUE_IS_NUMBER (cell->value))
+			*res = value_get_as_float (cell->value);
+		else
+			return FALSE;
+		return TRUE;
+	}
+
+	case GNM_EXPR_OP_PAREN:
+	case GNM_EXPR_OP_UNARY_PLUS:
+		return gnm_expr_eval_float (expr->unary.value, pos, res, depth);
+
+	case GNM_EXPR_OP_UNARY_NEG:
+		if (!gnm_expr_eval_float (expr->unary.value, pos, &a, depth))
+			return FALSE;
+		*res = 0 - a;
+		return TRUE;
+
+	case GNM_EXPR_OP_ADD:
+	case GNM_EXPR_OP_SUB:
+	case GNM_EXPR_OP_MULT:
+	case GNM_EXPR_OP_DIV:
+	case GNM_EXPR_OP_EXP:
+		/* Bound the work wasted if we end up giving up.  */
+		if (depth <= 0)
+			return FALSE;
+		return gnm_expr_eval_float (expr->binary.value_a, pos, &a, depth - 1) &&
+			gnm_expr_eval_float (expr->binary.value_b, pos, &b, depth - 1) &&
+			arith_float (GNM_EXPR_GET_OPER (expr), a, b, res);
+
+	default:
+		return FALSE;
+	}
+}
+
 static GnmValue *
 bin_arith (GnmExpr const *expr, GnmEvalPos const *ep,
 	   GnmValue const *a, GnmValue const *b)
@@ -1402,6 +1499,13 @@ gnm_expr_eval (GnmExpr const *expr, GnmEvalPos const *pos,
 		 * 5) result of operation, or error specific to the operation
 		 */
 
+		/* Plain numbers need no intermediate values.  */
+		{
+			gnm_float x;
+			if (gnm_expr_eval_float (expr, pos, &x, 4))
+				return value_new_float (x);
+		}
+
 		/* Guarantees value != NULL */
 		flags &= ~GNM_EXPR_EVAL_PERMIT_EMPTY;
 		flags &= ~GNM_EXPR_EVAL_WANT_REF;
@@ -1566,7 +1670,14 @@ gnm_expr_eval (GnmExpr const *expr, GnmEvalPos const *pos,
 		ei.pos = pos;
 		ei.func_call = &expr->func;
 		ei.flags = flags;
-		res = function_call_with_exprs (&ei);
+		if (G_UNLIKELY (gnm_recalc_profiling)) {
+			GnmRecalcProfileFrame frame;
+			gnm_recalc_profile_enter (&frame);
+			res = function_call_with_exprs (&ei);
+			gnm_recalc_profile_leave_func (&frame, expr->func.func,
+						       pos->sheet);
+		} else
+			res = function_call_with_exprs (&ei);
 		if (res == NULL)
 			return (flags & GNM_EXPR_EVAL_PERMIT_EMPTY)
 			    ? NULL : value_new_int (0);
@@ -2991,6 +3102,243 @@ gnm_expr_sharer_report (GnmExprSharer *es)
 
 /***************************************************************************/
 
+/*
+ * Most formulas in a typical sheet are plain arithmetic over cell
+ * references and numbers, like =A1*B1+C1.  For those we keep a flat
+ * postfix program next to the tree and run it on a stack of unboxed
+ * numbers.  Anything unusual -- a non-numeric operand, a division by
+ * zero, an overflow -- makes the program give up, and the tree is
+ * evaluated instead.  That keeps all error and conversion handling
+ * in one place.
+ */
+
+typedef enum {
+	EP_CONST,
+	EP_CELLREF,
+	EP_NEG,
+	EP_BINARY
+} GnmExprProgramOp;
+
+typedef struct {
+	GnmExprProgramOp op;
+	union {
+		gnm_float x;
+		GnmCellRef const *ref;
+		GnmExprOp oper;
+	} u;
+} GnmExprInstr;
+
+typedef struct {
+	int len;
+	GnmExprInstr code[1];
+} GnmExprProgram;
+
+#define EP_MAX_LEN 64
+#define EP_MAX_DEPTH 16
+
+/* Marks an expression we have tried, and failed, to compile.  */
+static char const gnm_expr_no_program[1] = { 0 };
+
+typedef struct {
+	GnmExprInstr code[EP_MAX_LEN];
+	int len, depth, max_depth;
+} GnmExprCompiler;
+
+static gboolean
+gnm_expr_compile (GnmExprCompiler *c, GnmExpr const *expr)
+{
+	GnmExprInstr *ins;
+
+	if (c->len >= EP_MAX_LEN)
+		return FALSE;
+
+	switch (GNM_EXPR_GET_OPER (expr)) {
+	case GNM_EXPR_OP_PAREN:
+	case GNM_EXPR_OP_UNARY_PLUS:
+		return gnm_expr_compile (c, expr->unary.value);
+
+	case GNM_EXPR_OP_UNARY_NEG:
+		if (!gnm_expr_compile (c, expr->unary.value))
+			return FALSE;
+		ins = c->code + c->len - 1;
+		if (ins->op == EP_CONST)
+			ins->u.x = 0 - ins->u.x;
+		else {
+			if (c->len >= EP_MAX_LEN)
+				return FALSE;
+			c->code[c->len++].op = EP_NEG;
+		}
+		return TRUE;
+
+	case GNM_EXPR_OP_ADD:
+	case GNM_EXPR_OP_SUB:
+	case GNM_EXPR_OP_MULT:
+	case GNM_EXPR_OP_DIV:
+	case GNM_EXPR_OP_EXP:
+		break;
+
+	case GNM_EXPR_OP_CONSTANT: {
+		GnmValue const *v = expr->constant.value;
+		if (!VALUE_IS_NUMBER (v))
+			return FALSE;
+		ins = c->code + c->len++;
+		ins->op = EP_CONST;
+		ins->u.x = value_get_as_float (v);
+		goto push;
+	}
+
+	case GNM_EXPR_OP_CELLREF:
+		ins = c->code + c->len++;
+		ins->op = EP_CELLREF;
+		ins->u.ref = &expr->cellref.ref;
+		goto push;
+
+	default:
+		return FALSE;
+	}
+
+	if (!gnm_expr_compile (c, expr->binary.value_a) ||
+	    !gnm_expr_compile (c, expr->binary.value_b))
+		return FALSE;
+
+	/* Fold constants, unless doing so would hide an error.  */
+	if (c->code[c->len - 2].op == EP_CONST &&
+	    c->code[c->len - 1].op == EP_CONST) {
+		gnm_float x;
+		if (arith_float (GNM_EXPR_GET_OPER (expr),
+				 c->code[c->len - 2].u.x,
+				 c->code[c->len - 1].u.x, &x)) {
+			c->len--;
+			c->depth--;
+			c->code[c->len - 1].u.x = x;
+			return TRUE;
+		}
+	}
+
+	if (c->len >= EP_MAX_LEN)
+		return FALSE;
+	ins = c->code + c->len++;
+	ins->op = EP_BINARY;
+	ins->u.oper = GNM_EXPR_GET_OPER (expr);
+	c->depth--;
+	return TRUE;
+
+ push:
+	if (++c->depth > c->max_depth)
+		c->max_depth = c->depth;
+	return c->max_depth <= EP_MAX_DEPTH;
+}
+
+static GnmExprProgram const *
+gnm_expr_top_get_program (GnmExprTop const *texpr)
+{
+	static int enabled = -1;
+	GnmExprCompiler c;
+	GnmExprProgram *prog;
+
+	if (texpr->program)
+		return texpr->program == gnm_expr_no_program
+			? NULL
+			: texpr->program;
+
+	if (enabled < 0)
+		enabled = !gnm_debug_flag ("no-expr-program");
+
+	c.len = c.depth = c.max_depth = 0;
+	switch (GNM_EXPR_GET_OPER (texpr->expr)) {
+	case GNM_EXPR_OP_ADD:
+	case GNM_EXPR_OP_SUB:
+	case GNM_EXPR_OP_MULT:
+	case GNM_EXPR_OP_DIV:
+	case GNM_EXPR_OP_EXP:
+		/*
+		 * Only a binary operator at the top is certain to
+		 * produce a result without a format.
+		 */
+		if (enabled && gnm_expr_compile (&c, texpr->expr))
+			break;
+		/* Fall through */
+	default:
+		((GnmExprTop *)texpr)->program = (gpointer)gnm_expr_no_program;
+		return NULL;
+	}
+
+	prog = g_malloc (sizeof (GnmExprProgram) +
+			 (c.len - 1) * sizeof (GnmExprInstr));
+	prog->len = c.len;
+	memcpy (prog->code, c.code, c.len * sizeof (GnmExprInstr));
+	((GnmExprTop *)texpr)->program = prog;
+	return prog;
+}
+
+static void
+gnm_expr_program_free (gpointer prog)
+{
+	if (prog != gnm_expr_no_program)
+		g_free (prog);
+}
+
+/*
+ * Returns TRUE and sets *res if the program ran to completion.  FALSE
+ * means the tree must be evaluated instead.
+ */
+static gboolean
+gnm_expr_program_run (GnmExprProgram const *prog, GnmEvalPos const *pos,
+		      gnm_float *res)
+{
+	gnm_float stack[EP_MAX_DEPTH];
+	int sp = 0, i;
+
+	for (i = 0; i < prog->len; i++) {
+		GnmExprInstr const *ins = prog->code + i;
+
+		switch (ins->op) {
+		case EP_CONST:
+			stack[sp++] = ins->u.x;
+			break;
+
+		case EP_CELLREF: {
+			GnmCellRef r;
+			GnmCell *cell;
+			GnmValue const *v;
+
+			gnm_cellref_make_abs (&r, ins->u.ref, pos);
+			cell = sheet_cell_get (eval_sheet (r.sheet, pos->sheet),
+					       r.col, r.row);
+			if (cell == NULL) {
+				stack[sp++] = 0;
+				break;
+			}
+			gnm_dep_cell_eval (cell);
+			v = cell->value;
+			if (VALUE_IS_EMPTY (v))
+				stack[sp++] = 0;
+			else if (VALUE_IS_NUMBER (v))
+				stack[sp++] = value_get_as_float (v);
+			else
+				return FALSE;
+			break;
+		}
+
+		case EP_NEG:
+			stack[sp - 1] = 0 - stack[sp - 1];
+			break;
+
+		case EP_BINARY:
+			sp--;
+			if (!arith_float (ins->u.oper, stack[sp - 1],
+					  stack[sp], stack + sp - 1))
+				return FALSE;
+			break;
+		}
+	}
+
+	*res = stack[0];
+	return TRUE;
+}
+
+/***************************************************************************/
+
 /**
  * gnm_expr_top_new:
  * @e: (transfer full): expression.
@@ -3010,6 +3358,7 @@ gnm_expr_top_new (GnmExpr const *expr)
 	res->hash = 0;
 	res->refcount = 1;
 	res->expr = expr;
+	res->program = NULL;
 	return res;
 }
 
@@ -3085,6 +3434,7 @@ gnm_expr_top_unref (GnmExprTop const *texpr)
 
 	((GnmExprTop *)texpr)->refcount--;
 	if (texpr->refcount == 0) {
+		gnm_expr_program_free (texpr->program);
 		gnm_expr_free (texpr->expr);
 		((GnmExprTop *)texpr)->magic = 0;
 		g_free ((GnmExprTop *)texpr);
@@ -3518,8 +3868,15 @@ gnm_expr_top_eval (GnmExprTop const *texpr,
 		res = gnm_expr_top_eval_array_corner (texpr, pos, flags);
 	else if (gnm_expr_top_is_array_elem (texpr, NULL, NULL))
 		res = gnm_expr_top_eval_array_elem (texpr, pos, flags);
-	else
-		res = gnm_expr_eval (texpr->expr, pos, flags);
+	else {
+		GnmExprProgram const *prog = gnm_expr_top_get_program (texpr);
+		gnm_float x;
+
+		if (prog && gnm_expr_program_run (prog, pos, &x))
+			res = value_new_float (x);
+		else
+			res = gnm_expr_eval (texpr->expr, pos, flags);
+	}
 	gnm_app_recalc_finish ();
 
 	return res;
@@ -144,6 +144,7 @@ struct GnmExprTop_ {
 	unsigned hash : 24;  /* Zero meaning not yet computed.  */
 	guint32 refcount;
 	GnmExpr const *expr;
+	gpointer program;  /* Private, see gnm_expr_top_eval.  */
 };
 
 GnmExprTop const *gnm_expr_top_new		(GnmExpr const *e);
@@ -494,20 +494,20 @@ static GnmFuncDescriptor const builtins[] = {
 	/* --- Math --- */
 	{	"sum",		NULL,
 		help_sum,	NULL,	gnumeric_sum,
-		GNM_FUNC_SIMPLE + GNM_FUNC_AUTO_FIRST,
+		GNM_FUNC_PURE + GNM_FUNC_AUTO_FIRST,
 		GNM_FUNC_IMPL_STATUS_COMPLETE,
 		GNM_FUNC_TEST_STATUS_BASIC
 	},
 	{	"product",		NULL,
 		help_product,	NULL,	gnumeric_product,
-		GNM_FUNC_SIMPLE,
+		GNM_FUNC_PURE,
 		GNM_FUNC_IMPL_STATUS_COMPLETE,
 		GNM_FUNC_TEST_STATUS_BASIC
 	},
 	/* --- Gnumeric --- */
 	{	"gnumeric_version",	"",
 		help_gnumeric_version,	gnumeric_version, NULL,
-		GNM_FUNC_SIMPLE,
+		GNM_FUNC_PURE,
 		GNM_FUNC_IMPL_STATUS_UNIQUE_TO_GNUMERIC,
 		GNM_FUNC_TEST_STATUS_EXHAUSTIVE
 	},
@@ -530,7 +530,7 @@ static GnmFuncDescriptor const builtins[] = {
 	/* --- Logic --- */
 	{	"if", "b|EE",
 		help_if, gnumeric_if, NULL,
-		GNM_FUNC_SIMPLE + GNM_FUNC_AUTO_SECOND,
+		GNM_FUNC_PURE + GNM_FUNC_AUTO_SECOND,
 		GNM_FUNC_IMPL_STATUS_COMPLETE,
 		GNM_FUNC_TEST_STATUS_BASIC },
 	{ NULL }
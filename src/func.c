@@ -768,6 +768,40 @@ gnm_func_set_flags (GnmFunc *func, GnmFuncFlags f)
 	func->flags = f;
 }
 
+/**
+ * gnm_func_is_pure:
+ * @func: #GnmFunc
+ *
+ * A function is pure if its result is determined by its arguments alone
+ * and calling it has no side effects beyond the shared collection caches
+ * in collect.c.  Such a call may be evaluated once and reused, for example
+ * when all its arguments are constants.  Static tables that are filled
+ * lazily, such as those behind FACT and FIB, do not count as side effects
+ * since filling them never changes a result.
+ *
+ * This is a conservative test: only functions that declare
+ * %GNM_FUNC_PURE qualify, and volatile functions, placeholders and
+ * functions with custom dependency linking never do.
+ *
+ * Returns: %TRUE if @func is pure.
+ **/
+gboolean
+gnm_func_is_pure (GnmFunc const *func)
+{
+	g_return_val_if_fail (GNM_IS_FUNC (func), FALSE);
+
+	if ((func->flags & GNM_FUNC_PURE) == 0 ||
+	    (func->flags & (GNM_FUNC_VOLATILE | GNM_FUNC_IS_PLACEHOLDER)))
+		return FALSE;
+
+	if (func->fn_type == GNM_FUNC_TYPE_STUB)
+		return FALSE;
+
+	return !g_signal_has_handler_pending ((gpointer)func,
+					      signals[SIG_LINK_DEP], 0,
+					      FALSE);
+}
+
 /**
  * gnm_func_get_impl_status:
  * @func: #GnmFunc
@@ -74,6 +74,7 @@ typedef enum {
 	GNM_FUNC_SIMPLE			= 0,
 	GNM_FUNC_VOLATILE		= 1 << 0, /* eg now(), today() */
 	GNM_FUNC_RETURNS_NON_SCALAR	= 1 << 1, /* eg transpose(), mmult() */
+	GNM_FUNC_PURE			= 1 << 2, /* result depends on args only */
 
 	/* an unknown function that will hopefully be defined later */
 	GNM_FUNC_IS_PLACEHOLDER		= 1 << 3,
@@ -224,6 +225,7 @@ char const *gnm_func_gettext         (GnmFunc const *func, const char *str);
 
 GnmFuncFlags gnm_func_get_flags      (GnmFunc const *func);
 void        gnm_func_set_flags       (GnmFunc *func, GnmFuncFlags f);
+gboolean    gnm_func_is_pure         (GnmFunc const *func);
 
 
 GnmFuncImplStatus gnm_func_get_impl_status (GnmFunc const *func);
@@ -62,6 +62,7 @@ typedef struct GnmParseError_	        GnmParseError;
 typedef struct GnmParsePos_	        GnmParsePos;
 typedef struct GnmPasteTarget_		GnmPasteTarget;
 typedef struct GnmRangeRef_	        GnmRangeRef;	/* abs/rel range with sheet */
+typedef struct GnmRangeWatch_		GnmRangeWatch;
 typedef struct GnmRenderedRotatedValue_	GnmRenderedRotatedValue;
 typedef struct GnmRenderedValue_	GnmRenderedValue;
 typedef struct GnmRenderedValueCollection_ GnmRenderedValueCollection;
@@ -22,6 +22,7 @@
 #include <ranges.h>
 #include <sheet-merge.h>
 #include <gnm-format.h>
+#include <gutils.h>
 #include <goffice/goffice.h>
 
 #include <string.h>
@@ -807,6 +808,7 @@ typedef struct {
 	int size;
 	GnmCellPos last;
 	const GnmCell ** cells;
+	GnmExprSharer *sharer;
 } AutoFillerCopy;
 
 static void
@@ -885,6 +887,12 @@ afc_set_cell_hint (AutoFiller *af, GnmCell *cell, GnmCellPos const *pos,
 				gnm_expr_free (aexpr);
 			}
 		} else if (texpr) {
+			/*
+			 * Filling a block gives many identical relocated
+			 * expressions.  Keep one copy of each.
+			 */
+			if (afe->sharer)
+				texpr = gnm_expr_sharer_share (afe->sharer, texpr);
 			if (doit)
 				gnm_cell_set_expr (cell, texpr);
 			else
@@ -934,7 +942,8 @@ afc_hint (AutoFiller *af, GnmCellPos *pos, int n)
 }
 
 static AutoFiller *
-auto_filler_copy (int size, guint last_col, guint last_row)
+auto_filler_copy (int size, guint last_col, guint last_row,
+		  GnmExprSharer *sharer)
 {
 	AutoFillerCopy *res = g_new (AutoFillerCopy, 1);
 
@@ -948,6 +957,7 @@ auto_filler_copy (int size, guint last_col, guint last_row)
 	res->last.col = last_col;
 	res->last.row = last_row;
 	res->cells = g_new0 (GnmCell const *, size);
+	res->sharer = sharer;
 
 	return &res->filler;
 }
@@ -972,6 +982,7 @@ calc_steps (const GnmRange *r, int col_inc, int row_inc)
  * count_max: size of source+fill area in direction of fill.
  * region_size: size of source area in direction of fill.
  * (last_col,last_row): last cell of entire area being filled.
+ * sharer: shares the expressions filled in, if not NULL.
  */
 
 static char *
@@ -981,6 +992,7 @@ sheet_autofill_dir (Sheet *sheet, gboolean singleton,
 		    int count_max,
 		    int col_inc, int row_inc,
 		    int last_col, int last_row,
+		    GnmExprSharer *sharer,
 		    gboolean doit)
 {
 	GList *fillers = NULL;
@@ -1066,7 +1078,7 @@ sheet_autofill_dir (Sheet *sheet, gboolean singleton,
 		(fillers, auto_filler_month ());
 	fillers = g_list_prepend
 		(fillers, auto_filler_copy (true_region_size,
-					    last_col, last_row));
+					    last_col, last_row, sharer));
 	fillers = g_list_prepend (fillers, auto_filler_list (quarters, 50, TRUE));
 
 	fillers = g_list_prepend
@@ -1217,10 +1229,13 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 	GString *res = NULL;
 	GnmCellPos pos;
 	GnmRange const *mr;
+	GnmExprSharer *sharer = NULL;
 
 	g_return_val_if_fail (IS_SHEET (sheet), NULL);
 
-	if (!doit)
+	if (doit)
+		sharer = gnm_expr_sharer_new ();
+	else
 		res = g_string_new (NULL);
 
 	pos.col = base_col;
@@ -1236,7 +1251,7 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 							      w, ABS (base_col - (end_col - 1)),
 							      -1, 0,
 							      right_col, bottom_row,
-							      doit),
+							      sharer, doit),
 					  "\n");
 
 				pos.row = base_row - series;
@@ -1252,7 +1267,7 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 							      h, ABS (base_row - (end_row - 1)),
 							      0, -1,
 							      right_col, bottom_row,
-							      doit),
+							      sharer, doit),
 					  " | ");
 
 				pos.col = base_col - series;
@@ -1270,7 +1285,7 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 							      w, ABS (base_col - (end_col + 1)),
 							      1, 0,
 							      right_col, bottom_row,
-							      doit),
+							      sharer, doit),
 					  "\n");
 
 				pos.row = base_row + series;
@@ -1286,7 +1301,7 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 							      h, ABS (base_row - (end_row + 1)),
 							      0, 1,
 							      right_col, bottom_row,
-							      doit),
+							      sharer, doit),
 					  " | ");
 				pos.col = base_col + series;
 				mr = gnm_sheet_merge_contains_pos (sheet, &pos);
@@ -1295,6 +1310,14 @@ sheet_autofill_internal (Sheet *sheet, gboolean singleton,
 		}
 	}
 
+	if (sharer) {
+		if (gnm_debug_flag ("expr-sharer")) {
+			g_printerr ("Autofill:\n");
+			gnm_expr_sharer_report (sharer);
+		}
+		gnm_expr_sharer_unref (sharer);
+	}
+
 	return res;
 }
 
@@ -20,6 +20,11 @@ struct SheetPrivate_ {
 	unsigned char	 objects_changed;
 
 	double           pixels_per_pt;
+
+	/* Number of cells in cell_hash per row segment, indexed by
+	 * COLROW_SEGMENT_INDEX.  Lets range iteration skip blocks of rows
+	 * that have row info but no cells.  */
+	GArray          *segment_cell_count;
 };
 
 /* for internal use only */
@@ -855,6 +855,8 @@ gnm_sheet_init (Sheet *sheet)
 
 	sheet->cell_hash = g_hash_table_new ((GHashFunc)&cell_set_hash,
 					     (GCompareFunc)&cell_set_equal);
+	sheet->priv->segment_cell_count =
+		g_array_new (FALSE, TRUE, sizeof (guint));
 
 	/* Init preferences */
 	sheet->convs = g_object_ref ((gpointer)gnm_conventions_default);
@@ -4404,6 +4406,33 @@ sheet_foreach_cell_in_range (Sheet *sheet, CellIterFlags flags,
 }
 
 
+static void
+sheet_segment_cell_count_add (Sheet *sheet, int row, int delta)
+{
+	GArray *counts = sheet->priv->segment_cell_count;
+	guint ix = COLROW_SEGMENT_INDEX (row);
+
+	if (ix >= counts->len)
+		g_array_set_size (counts, ix + 1);
+	g_array_index (counts, guint, ix) += delta;
+}
+
+/*
+ * sheet_segment_has_cells:
+ * @sheet: #Sheet
+ * @row: a row in the segment to check
+ *
+ * Returns: %TRUE if the row segment containing @row has any cells.
+ */
+static gboolean
+sheet_segment_has_cells (Sheet const *sheet, int row)
+{
+	GArray const *counts = sheet->priv->segment_cell_count;
+	guint ix = COLROW_SEGMENT_INDEX (row);
+
+	return ix < counts->len && g_array_index (counts, guint, ix) > 0;
+}
+
 /**
  * sheet_foreach_cell_in_region:
  * @sheet: #Sheet
@@ -4542,6 +4571,14 @@ sheet_foreach_cell_in_region (Sheet *sheet, CellIterFlags flags,
 	for (iter.pp.eval.row = start_row;
 	     iter.pp.eval.row <= end_row;
 	     ++iter.pp.eval.row) {
+		/* skip segments whose rows carry formatting but no cells */
+		if (only_existing &&
+		    iter.pp.eval.row == COLROW_SEGMENT_START (iter.pp.eval.row) &&
+		    !sheet_segment_has_cells (sheet, iter.pp.eval.row)) {
+			iter.pp.eval.row = COLROW_SEGMENT_END (iter.pp.eval.row);
+			continue;
+		}
+
 		iter.ri = sheet_row_get (iter.pp.sheet, iter.pp.eval.row);
 
 		/* no need to check visibility, that would require a colinfo to exist */
@@ -4757,6 +4794,7 @@ sheet_cell_add_to_hash (Sheet *sheet, GnmCell *cell)
 	gnm_cell_unrender (cell);
 
 	g_hash_table_insert (sheet->cell_hash, cell, cell);
+	sheet_segment_cell_count_add (sheet, cell->pos.row, 1);
 
 	if (gnm_sheet_merge_is_corner (sheet, &cell->pos))
 		cell->base.flags |= GNM_CELL_IS_MERGED;
@@ -4883,7 +4921,8 @@ sheet_cell_remove_from_hash (Sheet *sheet, GnmCell *cell)
 	cell_unregister_span (cell);
 	if (gnm_cell_expr_is_linked (cell))
 		dependent_unlink (GNM_CELL_TO_DEP (cell));
-	g_hash_table_remove (sheet->cell_hash, cell);
+	if (g_hash_table_remove (sheet->cell_hash, cell))
+		sheet_segment_cell_count_add (sheet, cell->pos.row, -1);
 	cell->base.flags &= ~(GNM_CELL_IN_SHEET_LIST|GNM_CELL_IS_MERGED);
 }
 
@@ -5103,6 +5142,8 @@ sheet_destroy_contents (Sheet *sheet)
 	sheet_cell_foreach (sheet, (GHFunc) &cb_remove_allcells, NULL);
 	g_hash_table_destroy (sheet->cell_hash);
 	sheet->cell_hash = NULL;
+	g_array_free (sheet->priv->segment_cell_count, TRUE);
+	sheet->priv->segment_cell_count = NULL;
 
 	/* Delete in ascending order to avoid decrementing max_used each time */
 	for (i = 0; i <= sheet->cols.max_used; ++i)
@@ -5411,6 +5452,7 @@ sheet_cells_deps_move (GnmExprRelocateInfo *rinfo)
 		});
 
 	/* Phase 3: move everything and add cells to hash.  */
+	gnm_dep_batch_link_begin ();
 	for (ui = 0; ui < deps->len; ui++) {
 		GnmDependent *dep = g_ptr_array_index (deps, ui);
 
@@ -5422,6 +5464,7 @@ sheet_cells_deps_move (GnmExprRelocateInfo *rinfo)
 		if (dep->texpr)
 			dependent_link (dep);
 	}
+	gnm_dep_batch_link_end ();
 
 	g_ptr_array_free (deps, TRUE);
 }
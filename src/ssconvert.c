@@ -79,6 +79,9 @@ static gboolean ssconvert_one_file_per_sheet = FALSE;
 static gboolean ssconvert_object_export = FALSE;
 static GType ssconvert_object_export_type;
 static gboolean ssconvert_recalc = FALSE;
+static char *ssconvert_recalc_profile = NULL;
+static char *ssconvert_benchmark = NULL;
+static int ssconvert_benchmark_runs = 1;
 static gboolean ssconvert_solve = FALSE;
 static char *ssconvert_resize = NULL;
 static char *ssconvert_clipboard = NULL;
@@ -196,6 +199,27 @@ static const GOptionEntry ssconvert_options[] = {
 		NULL
 	},
 
+	{
+		"recalc-profile", 0,
+		0, G_OPTION_ARG_FILENAME, &ssconvert_recalc_profile,
+		N_("Write per-cell, per-function and per-sheet evaluation times as CSV"),
+		N_("file")
+	},
+
+	{
+		"benchmark", 0,
+		0, G_OPTION_ARG_FILENAME, &ssconvert_benchmark,
+		N_("Write the time taken by each step of the conversion as JSON"),
+		N_("file")
+	},
+
+	{
+		"benchmark-runs", 0,
+		0, G_OPTION_ARG_INT, &ssconvert_benchmark_runs,
+		N_("Number of times to repeat the conversion when benchmarking"),
+		N_("N")
+	},
+
 	{
 		"resize", 0,
 		G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_STRING, &ssconvert_resize,
@@ -248,6 +272,96 @@ static const GOptionEntry ssconvert_options[] = {
 	{ NULL }
 };
 
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Benchmark mode.  Each conversion records how long its steps took;
+ * after all runs the lot is written as JSON.
+ */
+typedef struct {
+	double load, set, recalc, incremental, save;
+} BenchmarkRun;
+
+static GArray *benchmark_runs;
+
+static double
+benchmark_since (gint64 t0)
+{
+	return (g_get_monotonic_time () - t0) / 1e6;
+}
+
+/* Append @s as a JSON string.  Anything not ASCII is passed through.  */
+static void
+benchmark_append_json_string (GString *out, char const *s)
+{
+	g_string_append_c (out, '"');
+	for (; *s; s++) {
+		guchar c = *s;
+		if (c == '"' || c == '\\') {
+			g_string_append_c (out, '\\');
+			g_string_append_c (out, c);
+		} else if (c < 0x20)
+			g_string_append_printf (out, "\\u%04x", c);
+		else
+			g_string_append_c (out, c);
+	}
+	g_string_append_c (out, '"');
+}
+
+static int
+benchmark_report (char const *infile)
+{
+	GString *out = g_string_new (NULL);
+	GError *err = NULL;
+	gboolean ok;
+	unsigned ui;
+#ifdef HAVE_SYS_RESOURCE_H
+	struct rusage usage;
+#endif
+
+	g_string_append (out, "{\n  \"file\": ");
+	benchmark_append_json_string (out, infile);
+	g_string_append (out, ",\n");
+
+#ifdef HAVE_SYS_RESOURCE_H
+	if (getrusage (RUSAGE_SELF, &usage) == 0)
+		g_string_append_printf (out, "  \"peak_rss_kb\": %ld,\n",
+					(long)usage.ru_maxrss);
+#endif
+
+	g_string_append (out, "  \"runs\": [");
+	for (ui = 0; ui < benchmark_runs->len; ui++) {
+		BenchmarkRun const *run =
+			&g_array_index (benchmark_runs, BenchmarkRun, ui);
+		g_string_append_printf
+			(out,
+			 "%s\n    { \"load\": %.6f, \"set\": %.6f, "
+			 "\"recalc\": %.6f, \"incremental\": %.6f, "
+			 "\"save\": %.6f }",
+			 ui ? "," : "",
+			 run->load, run->set, run->recalc,
+			 run->incremental, run->save);
+	}
+	g_string_append (out, "\n  ]\n}\n");
+
+	if (strcmp (ssconvert_benchmark, "-") == 0) {
+		fputs (out->str, stdout);
+		ok = TRUE;
+	} else
+		ok = g_file_set_contents (ssconvert_benchmark,
+					  out->str, out->len, &err);
+	if (!ok) {
+		g_printerr (_("Failed to write benchmark results: %s\n"),
+			    err->message);
+		g_error_free (err);
+	}
+
+	g_string_free (out, TRUE);
+	return ok ? 0 : 1;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static GnmRangeRef const *
 setup_range (GObject *obj, const char *key, Workbook *wb, const char *rtxt)
 {
@@ -1300,6 +1414,8 @@ convert (char const *inarg, char const *outarg, char const *mergeargs[],
 	GOFileSaveScope fsscope;
 	GPtrArray *sheet_sel = NULL;
 	GnmRangeRef const *range = NULL;
+	BenchmarkRun run = { 0, 0, 0, 0, 0 };
+	gint64 t0;
 	gboolean user_selected_sheets;
 
 	if (ssconvert_object_export) {
@@ -1373,13 +1489,17 @@ convert (char const *inarg, char const *outarg, char const *mergeargs[],
 
 	io_context = go_io_context_new (cc);
 	if (mergeargs == NULL) {
+		t0 = g_get_monotonic_time ();
 		wbv = workbook_view_new_from_uri (infile, fo,
 						  io_context,
 						  ssconvert_import_encoding);
+		run.load = benchmark_since (t0);
+		t0 = g_get_monotonic_time ();
 		if (wbv && apply_updates (wbv)) {
 			res = 1;
 			goto out;
 		}
+		run.set = benchmark_since (t0);
 	} else {
 		wbv = workbook_view_new (NULL);
 	}
@@ -1465,9 +1585,32 @@ convert (char const *inarg, char const *outarg, char const *mergeargs[],
 		}
 	}
 
-	if (ssconvert_recalc)
+	if (ssconvert_recalc_profile)
+		gnm_recalc_profile_start ();
+	t0 = g_get_monotonic_time ();
+	if (ssconvert_recalc || ssconvert_benchmark || ssconvert_recalc_profile)
 		workbook_recalc_all (wb);
 	gnm_app_recalc ();
+	run.recalc = benchmark_since (t0);
+	if (ssconvert_recalc_profile) {
+		GError *err = NULL;
+		gnm_recalc_profile_stop ();
+		if (!gnm_recalc_profile_save (ssconvert_recalc_profile, &err)) {
+			g_printerr (_("Failed to write recalc profile: %s\n"),
+				    err->message);
+			g_error_free (err);
+		}
+	}
+
+	if (ssconvert_benchmark && ssconvert_set_cells && mergeargs == NULL) {
+		/*
+		 * Setting the cells again dirties just what depends on
+		 * them, which measures an incremental recalc.
+		 */
+		t0 = g_get_monotonic_time ();
+		apply_updates (wbv);
+		run.incremental = benchmark_since (t0);
+	}
 
 	if (ssconvert_range)
 		range = setup_range (G_OBJECT (wb),
@@ -1496,11 +1639,15 @@ convert (char const *inarg, char const *outarg, char const *mergeargs[],
 					(GDestroyNotify)g_ptr_array_unref);
 	}
 
+	t0 = g_get_monotonic_time ();
 	if (ssconvert_one_file_per_sheet) {
 		res = do_split_save (fs, wbv, outarg, cc);
 	} else {
 		res = !workbook_view_save_as (wbv, fs, outfile, cc);
 	}
+	run.save = benchmark_since (t0);
+	if (benchmark_runs && res == 0)
+		g_array_append_val (benchmark_runs, run);
 
 	g_object_set_data (G_OBJECT (wb), SHEET_SELECTION_KEY, NULL);
  out:
@@ -1652,6 +1799,16 @@ main (int argc, char const **argv)
 
 	gnm_init ();
 
+	/*
+	 * A plain conversion never asks what depends on what, so do not
+	 * spend time and memory linking formulas unless something does.
+	 * Benchmarks link up front so the load time includes it.
+	 */
+	if (!ssconvert_recalc && !ssconvert_set_cells &&
+	    !ssconvert_benchmark && !ssconvert_recalc_profile &&
+	    !gnm_debug_flag ("no-lazy-link"))
+		gnm_dep_set_lazy_link (TRUE);
+
 	cc = gnm_cmd_context_stderr_new ();
 	gnm_plugins_init (GO_CMD_CONTEXT (cc));
 	go_plugin_db_activate_plugin_list (
@@ -1683,6 +1840,16 @@ main (int argc, char const **argv)
 				       argv + 1, cc);
 		else
 			do_usage = TRUE;
+	} else if (ssconvert_benchmark && (argc == 2 || argc == 3)) {
+		int i;
+
+		benchmark_runs = g_array_new (FALSE, FALSE, sizeof (BenchmarkRun));
+		for (i = 0; res == 0 && i < MAX (1, ssconvert_benchmark_runs); i++)
+			res = convert (argv[1], argv[2], NULL, cc);
+		if (res == 0)
+			res = benchmark_report (argv[1]);
+		g_array_free (benchmark_runs, TRUE);
+		benchmark_runs = NULL;
 	} else if (argc == 2 || argc == 3) {
 		res = convert (argv[1], argv[2], NULL, cc);
 	} else
@@ -20,7 +20,9 @@
 #include <cell.h>
 #include <value.h>
 #include <func.h>
+#include <dependent.h>
 #include <ranges.h>
+#include <clipboard.h>
 #include <sheet-object-cell-comment.h>
 #include <mathfunc.h>
 #include <gnm-random.h>
@@ -691,6 +693,33 @@ dump_sheet (Sheet *sheet, const char *header)
 	g_ptr_array_free (cells, TRUE);
 }
 
+static void
+edit_cell (Sheet *sheet, const char *where, const char *what)
+{
+	GnmCell *cell = fetch_cell (sheet, where);
+	if (cell)
+		sheet_cell_set_text (cell, what, NULL);
+}
+
+static void
+dump_values (Sheet *sheet, const char *header, const char *where)
+{
+	GnmRange r;
+	int col, row;
+	gboolean ok = range_parse (&r, where, gnm_sheet_get_size (sheet));
+	g_return_if_fail (ok);
+
+	if (header)
+		g_printerr ("# %s\n", header);
+	for (row = r.start.row; row <= r.end.row; row++) {
+		for (col = r.start.col; col <= r.end.col; col++) {
+			GnmCell *cell = sheet_cell_get (sheet, col, row);
+			g_printerr ("%s: %s\n",
+				    cell_coord_name (col, row),
+				    cell ? value_peek_string (cell->value) : "");
+		}
+	}
+}
 
 static void
 dump_names (Workbook *wb)
@@ -897,6 +926,422 @@ test_insert_delete (void)
 
 /* ------------------------------------------------------------------------- */
 
+/* Check B1, =MEDIAN(A1:A100)+C1 with C1 zero, against column A.  */
+static void
+check_median (Sheet *sheet, const char *header)
+{
+	gnm_float xs[100], m;
+	int i;
+
+	for (i = 0; i < 100; i++)
+		xs[i] = value_get_as_float (sheet_cell_get (sheet, 0, i)->value);
+	gnm_range_median_inter (xs, 100, &m);
+
+	g_printerr ("# %s\n", header);
+	g_printerr ("B1 agrees: %s\n",
+		    value_get_as_float (fetch_cell (sheet, "B1")->value) == m
+		    ? "yes" : "no");
+}
+
+static void
+test_collect_cache (void)
+{
+	const char *test_name = "test_collect_cache";
+	Workbook *wb;
+	Sheet *sheet;
+	int i;
+
+	mark_test_start (test_name);
+
+	wb = workbook_new ();
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	/* A range of 100 cells is big enough for the collect cache.  */
+	for (i = 1; i <= 100; i++)
+		set_cell (sheet, cell_coord_name (0, i - 1), "=RAND()");
+	set_cell (sheet, "C1", "0");
+	set_cell (sheet, "B1", "=MEDIAN(A1:A100)+C1");
+	workbook_recalc_all (wb);
+	check_median (sheet, "Init");
+
+	workbook_recalc_all (wb);
+	check_median (sheet, "Recalc all");
+
+	workbook_queue_volatile_recalc (wb);
+	workbook_recalc (wb);
+	edit_cell (sheet, "C1", "0");
+	workbook_recalc (wb);
+	check_median (sheet, "Volatile recalc, then C1 changed");
+
+	workbook_set_recalcmode (wb, FALSE);
+	for (i = 1; i <= 100; i++) {
+		char *txt = g_strdup_printf ("%d", i);
+		set_cell (sheet, cell_coord_name (0, i - 1), txt);
+		g_free (txt);
+	}
+	workbook_recalc_all (wb);
+	check_median (sheet, "Manual recalc, constants");
+	dump_values (sheet, NULL, "B1");
+
+	/* Like deleting a sheet does, without recalculating.  */
+	workbook_queue_all_recalc (wb);
+	edit_cell (sheet, "A1", "1000");
+	workbook_recalc (wb);
+	check_median (sheet, "All queued, then A1 changed");
+	dump_values (sheet, NULL, "B1");
+
+	g_object_unref (wb);
+
+	mark_test_end (test_name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void
+test_lazy_link (void)
+{
+	const char *test_name = "test_lazy_link";
+	Workbook *wb;
+	Sheet *data, *sheet;
+	GOUndo *u;
+
+	mark_test_start (test_name);
+
+	/* Nothing below forces the pending links in, so they go in when
+	 * the edits and the insertion first need them.  */
+	gnm_dep_set_lazy_link (TRUE);
+
+	wb = workbook_new ();
+	data = workbook_sheet_add (wb, -1,
+				   GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	set_cell (data, "A1", "1");
+	set_cell (data, "A2", "2");
+	set_cell (data, "A3", "3");
+	define_name ("Total", "Sheet1!$A$1:$A$3", wb);
+	define_name ("Scaled", "Sheet1!$A$1*100", wb);
+	set_cell (sheet, "A1", "=Sheet1!A1*10");
+	set_cell (sheet, "A2", "=SUM(Total)");
+	set_cell (sheet, "A3", "=INDIRECT(\"Sheet1!A2\")+INDIRECT(\"Sheet1!A\"&3)");
+	set_cell (sheet, "A4", "=A1+A2+A3");
+	set_cell (sheet, "A5", "=Scaled+Sheet1!A3");
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Init", "A1:A5");
+
+	edit_cell (data, "A1", "5");
+	workbook_recalc (wb);
+	dump_values (sheet, "Sheet1!A1 changed", "A1:A5");
+
+	edit_cell (data, "A2", "7");
+	workbook_recalc (wb);
+	dump_values (sheet, "Sheet1!A2 changed", "A1:A5");
+
+	sheet_insert_rows (data, 0, 1, &u, NULL);
+	g_object_unref (u);
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Row inserted before Sheet1!A1", "A1:A5");
+
+	edit_cell (data, "A4", "4");
+	workbook_recalc (wb);
+	dump_values (sheet, "Sheet1!A4 changed", "A1:A5");
+
+	edit_cell (data, "A2", "6");
+	workbook_recalc (wb);
+	dump_values (sheet, "Sheet1!A2 changed", "A1:A5");
+
+	g_object_unref (wb);
+
+	gnm_dep_set_lazy_link (FALSE);
+
+	mark_test_end (test_name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void
+test_lookup_cache (void)
+{
+	const char *test_name = "test_lookup_cache";
+	Workbook *wb;
+	Sheet *sheet;
+	int i;
+
+	mark_test_start (test_name);
+
+	wb = workbook_new ();
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	/* The key in E1 follows A5, so it must always be found in row 5.  */
+	for (i = 1; i <= 30; i++) {
+		char *txt = g_strdup_printf ("%d", i);
+		set_cell (sheet, cell_coord_name (0, i - 1), "=RAND()");
+		set_cell (sheet, cell_coord_name (1, i - 1), txt);
+		g_free (txt);
+	}
+	set_cell (sheet, "E1", "=A5");
+	set_cell (sheet, "D1", "=MATCH(E1,A1:A30,0)");
+	set_cell (sheet, "D2", "=VLOOKUP(E1,A1:B30,2,FALSE)");
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Init", "D1:D2");
+
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Recalc all", "D1:D2");
+
+	workbook_set_recalcmode (wb, FALSE);
+	workbook_queue_all_recalc (wb);
+	edit_cell (sheet, "A5", "12345");
+	workbook_recalc (wb);
+	dump_values (sheet, "Manual recalc, all queued, then A5 changed",
+		     "D1:D2");
+
+	g_object_unref (wb);
+
+	mark_test_end (test_name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void
+test_criteria_cache (void)
+{
+	const char *test_name = "test_criteria_cache";
+	Workbook *wb;
+	Sheet *sheet;
+	int i;
+
+	mark_test_start (test_name);
+
+	wb = workbook_new ();
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	/* Ranges of 40 cells are big enough for the criteria cache.  */
+	for (i = 1; i <= 40; i++) {
+		char *txt = g_strdup_printf ("%d", i);
+		GnmCell *cell = sheet_cell_fetch (sheet, 0, i - 1);
+		gnm_cell_set_text (cell, i % 3 == 0 ? "x" : "y");
+		cell = sheet_cell_fetch (sheet, 1, i - 1);
+		gnm_cell_set_text (cell, txt);
+		g_free (txt);
+	}
+	set_cell (sheet, "C1", "x");
+	set_cell (sheet, "A10", "=C1");
+	set_cell (sheet, "C2", "y");
+	set_cell (sheet, "A20", "=IF(RAND()<2,C2,\"\")");
+	set_cell (sheet, "D1", "=SUMIFS(B1:B40,A1:A40,\"x\")");
+	set_cell (sheet, "D2", "=COUNTIFS(A1:A40,\"x\",B1:B40,\">5\")");
+	set_cell (sheet, "D3", "=ROUND(AVERAGEIFS(B1:B40,A1:A40,\"y\"),4)");
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Init", "D1:D3");
+
+	edit_cell (sheet, "A3", "y");
+	workbook_recalc (wb);
+	dump_values (sheet, "Criteria cell A3 changed", "D1:D3");
+
+	edit_cell (sheet, "C1", "y");
+	workbook_recalc (wb);
+	dump_values (sheet, "Formula A10 in criteria range changed", "D1:D3");
+
+	edit_cell (sheet, "B6", "1");
+	workbook_recalc (wb);
+	dump_values (sheet, "Value and criteria cell B6 changed", "D1:D3");
+
+	edit_cell (sheet, "A3", "x");
+	workbook_recalc (wb);
+	dump_values (sheet, "Criteria cell A3 changed back", "D1:D3");
+
+	/* C2 is changed behind the back of A20, so only recalcing all can
+	 * notice.  */
+	set_cell (sheet, "C2", "x");
+	workbook_recalc_all (wb);
+	dump_values (sheet, "Recalc all, volatile A20 in criteria range changed",
+		     "D1:D3");
+
+	g_object_unref (wb);
+
+	mark_test_end (test_name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Check every formula in column B against the running sum of column A,
+ * then show a few of them.
+ */
+static void
+check_running_sums (Sheet *sheet, const char *header)
+{
+	static const char *const cells[] = {
+		"B1", "B128", "B129", "B150", "B250"
+	};
+	int row, bad = 0;
+	gnm_float sum = 0;
+	unsigned ui;
+
+	for (row = 0; row < 310; row++) {
+		GnmCell *a = sheet_cell_get (sheet, 0, row);
+		GnmCell *b = sheet_cell_get (sheet, 1, row);
+
+		if (a)
+			sum += value_get_as_float (a->value);
+		if (b && gnm_cell_has_expr (b) &&
+		    value_get_as_float (b->value) != sum)
+			bad++;
+	}
+
+	g_printerr ("# %s\n", header);
+	g_printerr ("Mismatches: %d\n", bad);
+	for (ui = 0; ui < G_N_ELEMENTS (cells); ui++)
+		dump_values (sheet, NULL, cells[ui]);
+}
+
+static void
+test_running_ranges (void)
+{
+	const char *test_name = "test_running_ranges";
+	Workbook *wb;
+	Sheet *sheet;
+	GOUndo *u;
+	int i;
+
+	mark_test_start (test_name);
+
+	wb = workbook_new ();
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	/*
+	 * Filled down this far, the ranges cross two bucket boundaries
+	 * and most of them are kept together as one family.
+	 */
+	for (i = 1; i <= 300; i++) {
+		char *txt = g_strdup_printf ("=SUM($A$1:A%d)", i);
+		set_cell (sheet, cell_coord_name (0, i - 1), "1");
+		set_cell (sheet, cell_coord_name (1, i - 1), txt);
+		g_free (txt);
+	}
+	workbook_recalc_all (wb);
+	check_running_sums (sheet, "Init");
+
+	edit_cell (sheet, "A1", "10");
+	workbook_recalc (wb);
+	check_running_sums (sheet, "Anchor A1 changed");
+
+	edit_cell (sheet, "A150", "5");
+	workbook_recalc (wb);
+	check_running_sums (sheet, "A150 changed");
+
+	sheet_insert_rows (sheet, 199, 2, &u, NULL);
+	g_object_unref (u);
+	edit_cell (sheet, "A200", "100");
+	workbook_recalc (wb);
+	check_running_sums (sheet, "Two rows inserted before row 200, A200 set");
+
+	sheet_delete_rows (sheet, 99, 5, &u, NULL);
+	g_object_unref (u);
+	workbook_recalc (wb);
+	check_running_sums (sheet, "Rows 100 to 104 deleted");
+
+	edit_cell (sheet, "A120", "3");
+	workbook_recalc (wb);
+	check_running_sums (sheet, "A120 changed");
+
+	g_object_unref (wb);
+
+	mark_test_end (test_name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Check the formulas pasted into B301:C500 against column A, then show
+ * a few of them.
+ */
+static void
+check_pasted (Sheet *sheet, const char *header)
+{
+	static const char *const cells[] = {
+		"B301", "C301", "B350", "C350", "C500"
+	};
+	int row, bad = 0;
+	gnm_float sum = 0;
+	unsigned ui;
+
+	for (row = 0; row < 500; row++) {
+		gnm_float a = value_get_as_float
+			(sheet_cell_get (sheet, 0, row)->value);
+		sum += a;
+		if (row >= 300) {
+			GnmCell *b = sheet_cell_get (sheet, 1, row);
+			GnmCell *c = sheet_cell_get (sheet, 2, row);
+			if (b == NULL || value_get_as_float (b->value) != 2 * a)
+				bad++;
+			if (c == NULL || value_get_as_float (c->value) != sum)
+				bad++;
+		}
+	}
+
+	g_printerr ("# %s\n", header);
+	g_printerr ("Mismatches: %d\n", bad);
+	for (ui = 0; ui < G_N_ELEMENTS (cells); ui++)
+		dump_values (sheet, NULL, cells[ui]);
+}
+
+static void
+test_paste_links (void)
+{
+	const char *test_name = "test_paste_links";
+	Workbook *wb;
+	Sheet *sheet;
+	GnmCellRegion *cr;
+	GnmPasteTarget pt;
+	GnmRange r;
+	int i;
+
+	mark_test_start (test_name);
+
+	wb = workbook_new ();
+	sheet = workbook_sheet_add (wb, -1,
+				    GNM_DEFAULT_COLS, GNM_DEFAULT_ROWS);
+
+	for (i = 1; i <= 500; i++)
+		set_cell (sheet, cell_coord_name (0, i - 1), "1");
+	for (i = 1; i <= 200; i++) {
+		char *txt = g_strdup_printf ("=A%d*2", i);
+		set_cell (sheet, cell_coord_name (1, i - 1), txt);
+		g_free (txt);
+		txt = g_strdup_printf ("=SUM($A$1:A%d)", i);
+		set_cell (sheet, cell_coord_name (2, i - 1), txt);
+		g_free (txt);
+	}
+	workbook_recalc_all (wb);
+
+	/* The paste links the new formulas as one batch.  */
+	cr = clipboard_copy_range (sheet, range_init (&r, 1, 0, 2, 199));
+	paste_target_init (&pt, sheet, range_init (&r, 1, 300, 2, 499),
+			   PASTE_DEFAULT);
+	clipboard_paste_region (cr, &pt, NULL);
+	cellregion_unref (cr);
+	workbook_recalc (wb);
+	check_pasted (sheet, "Pasted B1:C200 into B301:C500");
+
+	edit_cell (sheet, "A1", "10");
+	workbook_recalc (wb);
+	check_pasted (sheet, "A1 changed");
+
+	edit_cell (sheet, "A350", "5");
+	workbook_recalc (wb);
+	check_pasted (sheet, "A350 changed");
+
+	g_object_unref (wb);
+
+	mark_test_end (test_name);
+}
+
 /* ------------------------------------------------------------------------- */
 
 static gboolean
@@ -3977,6 +4422,12 @@ main (int argc, char const **argv)
 
 	MAYBE_DO ("test_insdel_rowcol_names") test_insdel_rowcol_names ();
 	MAYBE_DO ("test_insert_delete") test_insert_delete ();
+	MAYBE_DO ("test_collect_cache") test_collect_cache ();
+	MAYBE_DO ("test_lookup_cache") test_lookup_cache ();
+	MAYBE_DO ("test_criteria_cache") test_criteria_cache ();
+	MAYBE_DO ("test_running_ranges") test_running_ranges ();
+	MAYBE_DO ("test_paste_links") test_paste_links ();
+	MAYBE_DO ("test_lazy_link") test_lazy_link ();
 	MAYBE_DO ("test_func_help") test_func_help ();
 	MAYBE_DO ("test_nonascii_numbers") test_nonascii_numbers ();
 	MAYBE_DO ("test_random") test_random ();
@@ -121,6 +121,13 @@ typedef struct {
 	/* Used internally for fixed width parsing */
 	int splitpos;          /* Indicates current position in splitpositions array */
 	int linepos;           /* Position on the current line */
+
+	/*
+	 * Used internally for csv parsing: bytes that may end a run of
+	 * plain field content outside and inside quotes.
+	 */
+	guint8 stop[256];
+	guint8 quoted_stop[256];
 } Source_t;
 
 /* Struct used for autodiscovery */
@@ -709,8 +716,19 @@ stf_parse_csv_cell (GString *text, Source_t *src, GnmStfParseOptions *parseoptio
 	if (parseoptions->stringindicator != 0 &&
 	    g_utf8_get_char (cur) == parseoptions->stringindicator) {
 		cur = g_utf8_next_char (cur);
-		while (*cur) {
-			gunichar uc = g_utf8_get_char (cur);
+		while (1) {
+			gunichar uc;
+			char const *run = cur;
+
+			/* Copy plain content in one go.  */
+			while (!src->quoted_stop[(guchar)*cur])
+				cur++;
+			if (cur != run)
+				g_string_append_len (text, run, cur - run);
+			if (*cur == 0)
+				break;
+
+			uc = g_utf8_get_char (cur);
 			cur = g_utf8_next_char (cur);
 
 			if (uc == parseoptions->stringindicator) {
@@ -740,8 +758,18 @@ stf_parse_csv_cell (GString *text, Source_t *src, GnmStfParseOptions *parseoptio
 	} else {
 		/* Unquoted field.  */
 
-		while (*cur && !compare_terminator (cur, parseoptions)) {
-			char const *post = stf_parse_csv_is_separator
+		while (1) {
+			char const *post, *run = cur;
+
+			/* Copy plain content in one go.  */
+			while (!src->stop[(guchar)*cur])
+				cur++;
+			if (cur != run)
+				g_string_append_len (text, run, cur - run);
+			if (*cur == 0 || compare_terminator (cur, parseoptions))
+				break;
+
+			post = stf_parse_csv_is_separator
 				(cur, parseoptions->sep.chr, parseoptions->sep.str);
 			if (post) {
 				cur = post;
@@ -901,6 +929,101 @@ stf_parse_fixed_line (Source_t *src, GnmStfParseOptions *parseoptions)
 }
 
 
+/*
+ * Set up @src for parsing @data, skipping any byte-order mark.
+ */
+static gboolean
+stf_parse_source_init (Source_t *src, GnmStfParseOptions *parseoptions,
+		       char const *data, char const *data_end)
+{
+	char const *valid_end = data_end;
+	GSList const *l;
+
+	g_return_val_if_fail (parseoptions != NULL, FALSE);
+	g_return_val_if_fail (data != NULL, FALSE);
+	g_return_val_if_fail (data_end != NULL, FALSE);
+	g_return_val_if_fail (stf_parse_options_valid (parseoptions), FALSE);
+	g_return_val_if_fail (g_utf8_validate (data, data_end-data, &valid_end), FALSE);
+
+	src->position = data;
+
+	/*
+	 * Any byte that starts a terminator, a separator, or the string
+	 * indicator needs a closer look.  Continuation bytes of UTF-8
+	 * characters never do, so we cannot stop in the middle of one.
+	 */
+	memset (src->stop, 0, sizeof (src->stop));
+	memset (src->quoted_stop, 0, sizeof (src->quoted_stop));
+	src->stop[0] = src->quoted_stop[0] = 1;
+	for (l = parseoptions->terminator; l; l = l->next) {
+		guchar const *term = l->data;
+		src->stop[*term] = 1;
+	}
+	for (l = parseoptions->sep.str; l; l = l->next) {
+		guchar const *sep = l->data;
+		src->stop[*sep] = 1;
+	}
+	if (parseoptions->sep.chr) {
+		char const *p;
+		for (p = parseoptions->sep.chr; *p; p = g_utf8_next_char (p))
+			src->stop[(guchar)*p] = 1;
+	}
+	if (parseoptions->stringindicator != 0) {
+		char buf[6];
+		g_unichar_to_utf8 (parseoptions->stringindicator, buf);
+		src->quoted_stop[(guchar)buf[0]] = 1;
+	}
+
+	if ((data_end-data >= 3) && g_str_has_prefix (src->position, "\xEF\xBB\xBF")) {
+		/* Skip over byte-order mark */
+		src->position += 3;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Lines parsed and stored at a time when we do not need them all at
+ * once.  This bounds the memory needed beyond the input itself.
+ */
+#define STF_PARSE_BATCH 4096
+
+/*
+ * Parse at most @max_lines more lines into @src->pl.  @row counts the
+ * lines parsed so far.
+ *
+ * Returns: %FALSE once there is nothing more to parse.
+ */
+static gboolean
+stf_parse_general_lines (GnmStfParseOptions *parseoptions, Source_t *src,
+			 char const *data_end, int *row, unsigned max_lines)
+{
+	unsigned n;
+
+	for (n = 0; n < max_lines; n++) {
+		GPtrArray *line;
+
+		if (*src->position == '\0' || src->position >= data_end)
+			return FALSE;
+
+		if (*row == GNM_MAX_ROWS) {
+			parseoptions->rows_exceeded = TRUE;
+			return FALSE;
+		}
+
+		line = parseoptions->parsetype == PARSE_TYPE_CSV
+			? stf_parse_csv_line (src, parseoptions)
+			: stf_parse_fixed_line (src, parseoptions);
+
+		g_ptr_array_add (src->pl->lines, line);
+		if (parseoptions->parsetype != PARSE_TYPE_CSV)
+			src->position += compare_terminator (src->position, parseoptions);
+		(*row)++;
+	}
+
+	return TRUE;
+}
+
 /**
  * stf_parse_general:
  * @parseoptions: #GnmStfParseOptions
@@ -914,45 +1037,62 @@ stf_parse_general (GnmStfParseOptions *parseoptions,
 		   char const *data, char const *data_end)
 {
 	Source_t src;
-	int row;
-	char const *valid_end = data_end;
+	int row = 0;
 
-	g_return_val_if_fail (parseoptions != NULL, NULL);
-	g_return_val_if_fail (data != NULL, NULL);
-	g_return_val_if_fail (data_end != NULL, NULL);
-	g_return_val_if_fail (stf_parse_options_valid (parseoptions), NULL);
-	g_return_val_if_fail (g_utf8_validate (data, data_end-data, &valid_end), NULL);
+	if (!stf_parse_source_init (&src, parseoptions, data, data_end))
+		return NULL;
 
 	GnmStfParsedLines *pl = gnm_stf_parsed_lines_new ();
-
 	src.pl = pl;
-	src.position = data;
-	row = 0;
+	stf_parse_general_lines (parseoptions, &src, data_end, &row, G_MAXUINT);
 
-	if ((data_end-data >= 3) && g_str_has_prefix (src.position, "\xEF\xBB\xBF")) {
-		/* Skip over byte-order mark */
-		src.position += 3;
-	}
+	return pl;
+}
 
-	while (*src.position != '\0' && src.position < data_end) {
-		GPtrArray *line;
+/**
+ * stf_parse_dimensions:
+ * @parseoptions: #GnmStfParseOptions
+ * @data: start of text to parse
+ * @data_end: end of text to parse
+ * @cols: (out): number of columns
+ * @rows: (out): number of rows
+ *
+ * Finds the size of the result of stf_parse_general without keeping
+ * all of it around.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+stf_parse_dimensions (GnmStfParseOptions *parseoptions,
+		      char const *data, char const *data_end,
+		      int *cols, int *rows)
+{
+	Source_t src;
+	gboolean more = TRUE;
+	unsigned ui;
 
-		if (row == GNM_MAX_ROWS) {
-			parseoptions->rows_exceeded = TRUE;
-			break;
-		}
+	*cols = *rows = 0;
 
-		line = parseoptions->parsetype == PARSE_TYPE_CSV
-			? stf_parse_csv_line (&src, parseoptions)
-			: stf_parse_fixed_line (&src, parseoptions);
+	if (!stf_parse_source_init (&src, parseoptions, data, data_end))
+		return FALSE;
 
-		g_ptr_array_add (pl->lines, line);
-		if (parseoptions->parsetype != PARSE_TYPE_CSV)
-			src.position += compare_terminator (src.position, parseoptions);
-		row++;
+	src.pl = gnm_stf_parsed_lines_new ();
+	while (more) {
+		GPtrArray *lines = src.pl->lines;
+
+		more = stf_parse_general_lines (parseoptions, &src, data_end,
+						rows, STF_PARSE_BATCH);
+		for (ui = 0; ui < lines->len; ui++) {
+			GPtrArray *line = g_ptr_array_index (lines, ui);
+			*cols = MAX (*cols, (int)line->len);
+			g_ptr_array_free (line, TRUE);
+		}
+		g_ptr_array_set_size (lines, 0);
+		g_string_chunk_clear (src.pl->lines_chunk);
 	}
+	g_object_unref (src.pl);
 
-	return pl;
+	return TRUE;
 }
 
 /**
@@ -1299,11 +1439,10 @@ stf_parse_options_fixed_autodiscover (GnmStfParseOptions *parseoptions,
  */
 
 static void
-stf_cell_set_text (GnmCell *cell, char const *text)
+stf_cell_set_text (GnmCell *cell, GOFormat const *fmt, char const *text)
 {
 	GnmExprTop const *texpr;
 	GnmValue *val;
-	GOFormat const *fmt = gnm_cell_get_format (cell);
 	const GODateConventions *date_conv = sheet_date_conv (cell->base.sheet);
 
 	if (!go_format_is_text (fmt) && *text == '=' && text[1] != 0) {
@@ -1331,6 +1470,63 @@ stf_cell_set_text (GnmCell *cell, char const *text)
 	}
 }
 
+/*
+ * Text imports often repeat a small set of values in a column, like
+ * categories or status codes.  Remember what each distinct text in a
+ * column turned into so repeats can skip format matching and share
+ * the interned string.  Columns that turn out not to repeat stop being
+ * looked up once the table is full.
+ */
+#define STF_VALUE_CACHE_SIZE 1024
+
+typedef struct {
+	GOFormat const *fmt;
+	GHashTable *values;
+	unsigned hits;
+	gboolean disabled;
+} StfValueCache;
+
+static void
+stf_value_cache_free (StfValueCache *vc)
+{
+	if (vc == NULL)
+		return;
+	g_hash_table_destroy (vc->values);
+	g_free (vc);
+}
+
+static StfValueCache *
+stf_value_cache_get (GPtrArray *caches, unsigned lcol)
+{
+	StfValueCache *vc;
+
+	if (lcol >= caches->len)
+		g_ptr_array_set_size (caches, lcol + 1);
+	vc = g_ptr_array_index (caches, lcol);
+	if (vc == NULL) {
+		vc = g_new0 (StfValueCache, 1);
+		vc->values = g_hash_table_new_full
+			(g_str_hash, g_str_equal,
+			 g_free, (GDestroyNotify)value_release);
+		g_ptr_array_index (caches, lcol) = vc;
+	}
+
+	return vc->disabled ? NULL : vc;
+}
+
+/*
+ * The result of parsing depends on the format used for it: the cell's
+ * format, or NULL for columns that use the decimal settings.
+ */
+static void
+stf_value_cache_set_format (StfValueCache *vc, GOFormat const *fmt)
+{
+	if (vc->fmt != fmt) {
+		g_hash_table_remove_all (vc->values);
+		vc->fmt = fmt;
+	}
+}
+
 static void
 stf_read_remember_settings (Workbook *book, GnmStfParseOptions *po)
 {
@@ -1353,6 +1549,42 @@ stf_read_remember_settings (Workbook *book, GnmStfParseOptions *po)
 	}
 }
 
+/*
+ * Apply the column formats to rows @start_row..@end_row.
+ */
+static void
+stf_apply_formats (GnmStfParseOptions *parseoptions, Sheet *sheet,
+		   int start_col, int start_row, int end_row)
+{
+	int col = start_col;
+	unsigned int lcol;
+	size_t nformats = parseoptions->formats->len;
+
+	end_row = MIN (end_row, gnm_sheet_get_last_row (sheet));
+	if (end_row < start_row)
+		return;
+
+	for (lcol = 0; lcol < nformats; lcol++) {
+		GOFormat const *fmt = g_ptr_array_index (parseoptions->formats, lcol);
+		GnmStyle *mstyle;
+		gboolean want_col =
+			(parseoptions->col_import_array == NULL ||
+			 parseoptions->col_import_array_len <= lcol ||
+			 parseoptions->col_import_array[lcol]);
+		if (!want_col || col >= gnm_sheet_get_max_cols (sheet))
+			continue;
+
+		if (fmt && !go_format_is_general (fmt)) {
+			GnmRange r;
+			range_init (&r, col, start_row, col, end_row);
+			mstyle = gnm_style_new ();
+			gnm_style_set_format (mstyle, fmt);
+			sheet_apply_style (sheet, &r, mstyle);
+		}
+		col++;
+	}
+}
+
 /**
  * stf_parse_sheet:
  * @parseoptions: #GnmStfParseOptions
@@ -1371,12 +1603,17 @@ stf_parse_sheet (GnmStfParseOptions *parseoptions,
 		 char const *data, char const *data_end,
 		 Sheet *sheet, int start_col, int start_row)
 {
-	int row;
+	Source_t src;
+	int row, batch_row;
+	int parsed_rows = 0;
 	unsigned int lrow;
 	gboolean result = TRUE;
+	gboolean more = TRUE;
 	int col;
 	unsigned int lcol;
 	size_t nformats;
+	GnmStfParsedLines *pl = NULL;
+	GPtrArray *vcaches;
 
 	SETUP_LOCALE_SWITCH;
 
@@ -1387,91 +1624,126 @@ stf_parse_sheet (GnmStfParseOptions *parseoptions,
 	if (!data_end)
 		data_end = data + strlen (data);
 
-	GnmStfParsedLines *pl = stf_parse_general (parseoptions, data, data_end);
-	if (pl == NULL)
+	if (stf_parse_source_init (&src, parseoptions, data, data_end)) {
+		pl = gnm_stf_parsed_lines_new ();
+		src.pl = pl;
+	} else
 		result = FALSE;
 
-	col = start_col;
 	nformats = parseoptions->formats->len;
-	for (lcol = 0; lcol < nformats; lcol++) {
-		GOFormat const *fmt = g_ptr_array_index (parseoptions->formats, lcol);
-		GnmStyle *mstyle;
-		gboolean want_col =
-			(parseoptions->col_import_array == NULL ||
-			 parseoptions->col_import_array_len <= lcol ||
-			 parseoptions->col_import_array[lcol]);
-		if (!want_col || col >= gnm_sheet_get_max_cols (sheet))
-			continue;
-
-		if (fmt && !go_format_is_general (fmt)) {
-			GnmRange r;
-			int end_row = MIN (start_row + (int)pl->lines->len - 1,
-					   gnm_sheet_get_last_row (sheet));
-
-			range_init (&r, col, start_row, col, end_row);
-			mstyle = gnm_style_new ();
-			gnm_style_set_format (mstyle, fmt);
-			sheet_apply_style (sheet, &r, mstyle);
-		}
-		col++;
-	}
+	vcaches = g_ptr_array_new_with_free_func
+		((GDestroyNotify)stf_value_cache_free);
 
+	/*
+	 * Parse and store a batch of lines at a time so we never hold
+	 * the parsed form of the whole input.
+	 */
 	START_LOCALE_SWITCH;
-	for (row = start_row, lrow = 0;
-	     result && lrow < pl->lines->len;
-	     row++, lrow++) {
-		GPtrArray *line;
+	for (batch_row = start_row; result && more; batch_row = row) {
+		more = stf_parse_general_lines (parseoptions, &src, data_end,
+						&parsed_rows,
+						STF_PARSE_BATCH);
+
+		stf_apply_formats (parseoptions, sheet, start_col, batch_row,
+				   batch_row + (int)pl->lines->len - 1);
+
+		for (row = batch_row, lrow = 0;
+		     lrow < pl->lines->len;
+		     row++, lrow++) {
+			GPtrArray *line;
+
+			if (row >= gnm_sheet_get_max_rows (sheet)) {
+				parseoptions->rows_exceeded = TRUE;
+				more = FALSE;
+				break;
+			}
 
-		if (row >= gnm_sheet_get_max_rows (sheet)) {
-			parseoptions->rows_exceeded = TRUE;
-			break;
-		}
+			col = start_col;
+			line = g_ptr_array_index (pl->lines, lrow);
+
+			for (lcol = 0; lcol < line->len; lcol++) {
+				GOFormat const *fmt = lcol < nformats
+					? g_ptr_array_index (parseoptions->formats, lcol)
+					: go_format_general ();
+				char const *text = g_ptr_array_index (line, lcol);
+				gboolean want_col =
+					(parseoptions->col_import_array == NULL ||
+					 parseoptions->col_import_array_len <= lcol ||
+					 parseoptions->col_import_array[lcol]);
+				if (!want_col)
+					continue;
+
+				if (col >= gnm_sheet_get_max_cols (sheet)) {
+					parseoptions->cols_exceeded = TRUE;
+					break;
+				}
+				if (text && *text) {
+					GnmCell *cell = sheet_cell_fetch (sheet, col, row);
+					gboolean decimal_col =
+						!go_format_is_text (fmt) &&
+						lcol < parseoptions->formats_decimal->len &&
+						g_ptr_array_index (parseoptions->formats_decimal, lcol);
+					gboolean decimal = decimal_col &&
+						text[0] != '=' && text[0] != '\'';
+					GOFormat const *cfmt = NULL;
+					StfValueCache *vc = NULL;
+					GnmValue const *known = NULL;
+
+					if (text[0] != '=') {
+						vc = stf_value_cache_get (vcaches, lcol);
+						if (vc) {
+							if (!decimal_col)
+								cfmt = gnm_cell_get_format (cell);
+							stf_value_cache_set_format (vc, cfmt);
+							known = g_hash_table_lookup (vc->values, text);
+						}
+					}
 
-		col = start_col;
-		line = g_ptr_array_index (pl->lines, lrow);
-
-		for (lcol = 0; lcol < line->len; lcol++) {
-			GOFormat const *fmt = lcol < nformats
-				? g_ptr_array_index (parseoptions->formats, lcol)
-				: go_format_general ();
-			char const *text = g_ptr_array_index (line, lcol);
-			gboolean want_col =
-				(parseoptions->col_import_array == NULL ||
-				 parseoptions->col_import_array_len <= lcol ||
-				 parseoptions->col_import_array[lcol]);
-			if (!want_col)
-				continue;
+					if (known) {
+						vc->hits++;
+						if (decimal)
+							sheet_cell_set_value (cell, value_dup (known));
+						else
+							gnm_cell_set_value (cell, value_dup (known));
+					} else if (decimal) {
+						GOFormatFamily fam;
+						GnmValue *v = format_match_decimal_number_with_locale
+							(text, &fam,
+							 g_ptr_array_index (parseoptions->formats_curr, lcol),
+							 g_ptr_array_index (parseoptions->formats_thousand, lcol),
+							 g_ptr_array_index (parseoptions->formats_decimal, lcol));
+						if (!v)
+							v = value_new_string (text);
+						sheet_cell_set_value (cell, v);
+					} else {
+						if (!cfmt)
+							cfmt = gnm_cell_get_format (cell);
+						stf_cell_set_text (cell, cfmt, text);
+					}
 
-			if (col >= gnm_sheet_get_max_cols (sheet)) {
-				parseoptions->cols_exceeded = TRUE;
-				break;
-			}
-			if (text && *text) {
-				GnmCell *cell = sheet_cell_fetch (sheet, col, row);
-				if (!go_format_is_text (fmt) &&
-				    text[0] != '=' && text[0] != '\'' &&
-				    lcol < parseoptions->formats_decimal->len &&
-				    g_ptr_array_index (parseoptions->formats_decimal, lcol)) {
-					GOFormatFamily fam;
-					GnmValue *v = format_match_decimal_number_with_locale
-						(text, &fam,
-						 g_ptr_array_index (parseoptions->formats_curr, lcol),
-						 g_ptr_array_index (parseoptions->formats_thousand, lcol),
-						 g_ptr_array_index (parseoptions->formats_decimal, lcol));
-					if (!v)
-						v = value_new_string (text);
-					sheet_cell_set_value (cell, v);
-				} else {
-					stf_cell_set_text (cell, text);
+					if (vc && !known && cell->value) {
+						if (g_hash_table_size (vc->values) < STF_VALUE_CACHE_SIZE)
+							g_hash_table_insert (vc->values,
+									     g_strdup (text),
+									     value_dup (cell->value));
+						else if (vc->hits < STF_VALUE_CACHE_SIZE) {
+							vc->disabled = TRUE;
+							g_hash_table_remove_all (vc->values);
+						}
+					}
 				}
+				col++;
 			}
-			col++;
 		}
 
-		g_ptr_array_index (pl->lines, lrow) = NULL;
-		g_ptr_array_free (line, TRUE);
+		/* Drop the batch, keeping the chunk for the next one.  */
+		for (lrow = 0; lrow < pl->lines->len; lrow++)
+			g_ptr_array_free (g_ptr_array_index (pl->lines, lrow), TRUE);
+		g_ptr_array_set_size (pl->lines, 0);
+		g_string_chunk_clear (pl->lines_chunk);
 	}
 	END_LOCALE_SWITCH;
+	g_ptr_array_unref (vcaches);
 
 	if (parseoptions->rows_exceeded) {
 		g_warning (_("There are more rows of data than "
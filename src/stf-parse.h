@@ -129,6 +129,10 @@ int stf_parse_options_fixed_splitpositions_nth         (GnmStfParseOptions *pars
 GnmStfParsedLines *stf_parse_general			(GnmStfParseOptions *parseoptions,
 							 char const *data,
 							 char const *data_end);
+gboolean	stf_parse_dimensions			(GnmStfParseOptions *parseoptions,
+							 char const *data,
+							 char const *data_end,
+							 int *cols, int *rows);
 GnmStfParsedLines *stf_parse_lines			(GnmStfParseOptions *parseoptions,
 							 char const *data,
 							 int maxlines,
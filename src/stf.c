@@ -397,7 +397,7 @@ stf_read_workbook_auto_csvtab (G_GNUC_UNUSED GOFileOpener const *fo, gchar const
 	size_t data_len;
 	GnmStfParseOptions *po;
 	const char *gsfname;
-	int cols, rows, i;
+	int cols, rows;
 	WorkbookView *wbv = GNM_WORKBOOK_VIEW (view);
 
 	g_return_if_fail (context != NULL);
@@ -435,16 +435,9 @@ stf_read_workbook_auto_csvtab (G_GNUC_UNUSED GOFileOpener const *fo, gchar const
 			po = stf_parse_options_guess (utf8data->str);
 	}
 
-	GnmStfParsedLines *pl = stf_parse_general (po,
-						   utf8data->str, utf8data->str + utf8data->len);
-	rows = pl->lines->len;
-	cols = 0;
-	for (i = 0; i < rows; i++) {
-		GPtrArray *line = g_ptr_array_index (pl->lines, i);
-		cols = MAX (cols, (int)line->len);
-	}
+	stf_parse_dimensions (po, utf8data->str, utf8data->str + utf8data->len,
+			      &cols, &rows);
 	gnm_sheet_suggest_size (&cols, &rows);
-	g_object_unref (pl);
 
 	name = g_path_get_basename (gsfname);
 	sheet = sheet_new (book, name, cols, rows);
@@ -43,6 +43,7 @@
 #include <gnm-sheet-slicer-combo.h>
 #include <position.h>
 #include <cell.h>
+#include <dependent.h>
 #include <gutils.h>
 #include <command-context.h>
 #include <auto-format.h>
@@ -1463,8 +1464,10 @@ workbook_view_new_from_input (GsfInput *input,
 		/* disable recursive dirtying while loading */
 		old = workbook_enable_recursive_dirty (new_wb, FALSE);
 		g_object_set (new_wb, "being-loaded", TRUE, NULL);
+		gnm_dep_batch_link_begin ();
 		go_file_opener_open (file_opener, encoding, io_context,
 		                     GO_VIEW (new_wbv), input);
+		gnm_dep_batch_link_end ();
 		g_object_set (new_wb, "being-loaded", FALSE, NULL);
 		workbook_enable_recursive_dirty (new_wb, old);
 
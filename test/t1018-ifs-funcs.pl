@@ -5,6 +5,49 @@ use strict;
 use lib ($0 =~ m|^(.*/)| ? $1 : ".");
 use GnumericTest;
 
+my $expected;
+{ local $/; $expected = <DATA>; }
+
 my $file = "excel12/ifs-funcs.xlsx";
 &message ("Check that $file evaluates correctly.");
 &test_sheet_calc ("$samples/$file", "Overview!C2:C99", sub { /(\s*0)+\s*/i });
+
+&message ("Check that *IFS results follow changes to their ranges.");
+&sstest ("test_criteria_cache", $expected);
+
+&message ("Check the same with a criteria cache that only keeps one bitmap.");
+{
+    local $ENV{'GNM_CRITERIA_CACHE_SIZE'} = 8;
+    &sstest ("test_criteria_cache", $expected);
+}
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_criteria_cache
+-----------------------------------------------------------------------------
+
+# Init
+D1: 283
+D2: 13
+D3: 20.6538
+# Criteria cell A3 changed
+D1: 280
+D2: 13
+D3: 20
+# Formula A10 in criteria range changed
+D1: 270
+D2: 12
+D3: 19.6429
+# Value and criteria cell B6 changed
+D1: 265
+D2: 11
+D3: 19.6429
+# Criteria cell A3 changed back
+D1: 268
+D2: 11
+D3: 20.2593
+# Recalc all, volatile A20 in criteria range changed
+D1: 288
+D2: 12
+D3: 20.2692
+End: test_criteria_cache
@@ -0,0 +1,62 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+my $expected;
+{ local $/; $expected = <DATA>; }
+
+&message ("Check filled-down running sums across edits and row insert/delete.");
+&sstest ("test_running_ranges", $expected);
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_running_ranges
+-----------------------------------------------------------------------------
+
+# Init
+Mismatches: 0
+B1: 1
+B128: 128
+B129: 129
+B150: 150
+B250: 250
+# Anchor A1 changed
+Mismatches: 0
+B1: 10
+B128: 137
+B129: 138
+B150: 159
+B250: 259
+# A150 changed
+Mismatches: 0
+B1: 10
+B128: 137
+B129: 138
+B150: 163
+B250: 263
+# Two rows inserted before row 200, A200 set
+Mismatches: 0
+B1: 10
+B128: 137
+B129: 138
+B150: 163
+B250: 361
+# Rows 100 to 104 deleted
+Mismatches: 0
+B1: 10
+B128: 137
+B129: 138
+B150: 163
+B250: 361
+# A120 changed
+Mismatches: 0
+B1: 10
+B128: 139
+B129: 140
+B150: 165
+B250: 363
+End: test_running_ranges
+
@@ -0,0 +1,40 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+my $expected;
+{ local $/; $expected = <DATA>; }
+
+&message ("Check that pasted formulas follow the cells they reference.");
+&sstest ("test_paste_links", $expected);
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_paste_links
+-----------------------------------------------------------------------------
+
+# Pasted B1:C200 into B301:C500
+Mismatches: 0
+B301: 2
+C301: 301
+B350: 2
+C350: 350
+C500: 500
+# A1 changed
+Mismatches: 0
+B301: 2
+C301: 310
+B350: 2
+C350: 359
+C500: 509
+# A350 changed
+Mismatches: 0
+B301: 2
+C301: 310
+B350: 10
+C350: 363
+C500: 513
+End: test_paste_links
@@ -0,0 +1,31 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+my $expected;
+{ local $/; $expected = <DATA>; }
+
+&message ("Check that cached ranges follow full, volatile and manual recalcs.");
+&sstest ("test_collect_cache", $expected);
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_collect_cache
+-----------------------------------------------------------------------------
+
+# Init
+B1 agrees: yes
+# Recalc all
+B1 agrees: yes
+# Volatile recalc, then C1 changed
+B1 agrees: yes
+# Manual recalc, constants
+B1 agrees: yes
+B1: 50.5
+# All queued, then A1 changed
+B1 agrees: yes
+B1: 51.5
+End: test_collect_cache
@@ -0,0 +1,28 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+my $expected;
+{ local $/; $expected = <DATA>; }
+
+&message ("Check that cached lookup tables follow full and manual recalcs.");
+&sstest ("test_lookup_cache", $expected);
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_lookup_cache
+-----------------------------------------------------------------------------
+
+# Init
+D1: 5
+D2: 5
+# Recalc all
+D1: 5
+D2: 5
+# Manual recalc, all queued, then A5 changed
+D1: 5
+D2: 5
+End: test_lookup_cache
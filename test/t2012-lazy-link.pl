@@ -0,0 +1,55 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+my $expected;
+{ local $/; $expected = <DATA>; }
+
+&message ("Check that edits and insertions work with lazy linking.");
+&sstest ("test_lazy_link", $expected);
+
+__DATA__
+-----------------------------------------------------------------------------
+Start: test_lazy_link
+-----------------------------------------------------------------------------
+
+# Init
+A1: 10
+A2: 6
+A3: 5
+A4: 21
+A5: 103
+# Sheet1!A1 changed
+A1: 50
+A2: 10
+A3: 5
+A4: 65
+A5: 503
+# Sheet1!A2 changed
+A1: 50
+A2: 15
+A3: 10
+A4: 75
+A5: 503
+# Row inserted before Sheet1!A1
+A1: 50
+A2: 15
+A3: 12
+A4: 77
+A5: 503
+# Sheet1!A4 changed
+A1: 50
+A2: 16
+A3: 12
+A4: 78
+A5: 504
+# Sheet1!A2 changed
+A1: 60
+A2: 17
+A3: 13
+A4: 90
+A5: 604
+End: test_lazy_link
@@ -0,0 +1,42 @@
+#!/usr/bin/perl -w
+# -----------------------------------------------------------------------------
+
+use strict;
+use lib ($0 =~ m|^(.*/)| ? $1 : ".");
+use GnumericTest;
+
+&message ("Check ssconvert with and without lazy linking");
+
+my $src = "$samples/lazy-link.gnumeric";
+&GnumericTest::report_skip ("file $src does not exist") unless -r $src;
+
+# The first sheet holds the inputs, the second has formulas that reach
+# them through plain references, names, and INDIRECT.  Lazy linking is
+# only used when neither --recalc nor --set is given, so only the plain
+# conversion is run both with and without it.
+my @cases =
+    (['', '10,6,5,21,103', 1],
+     ['', '10,6,5,21,103', 0],
+     ['--recalc', '10,6,5,21,103', 0],
+     ['--set A1=5', '50,10,5,65,503', 0],
+     ['--set A2=7 --recalc', '10,11,10,31,103', 0],
+     ['--set A3=4', '10,7,6,23,104', 0]);
+
+foreach (@cases) {
+    my ($args,$expected,$lazy) = @$_;
+    local $ENV{'GNM_DEBUG'} = $lazy ? '' : 'no-lazy-link';
+
+    my $cmd = "$ssconvert $args -O 'sheet=Main' -T Gnumeric_stf:stf_csv $src fd://1";
+    print STDERR "# $cmd\n" if $GnumericTest::verbose;
+    my $out = `$cmd`;
+    die "Failed command: $cmd\n" if $?;
+
+    $out =~ s/\r//g;
+    my $actual = join (',', split ("\n", $out));
+    if ($actual eq $expected) {
+	print STDERR "Pass\n";
+    } else {
+	print STDERR "Expected $expected, got $actual\n";
+	die "Fail\n";
+    }
+}